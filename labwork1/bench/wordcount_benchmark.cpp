@@ -0,0 +1,207 @@
+#include <lib/wordcount.h>
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+// Бенчмарки горячего цикла на синтетических корпусах. Размер входных файлов
+// ограничен переменной WORDCOUNT_BENCH_MAX_SIZE (в байтах, по умолчанию 256 МиБ):
+// для проверки на файлах в несколько гигабайт её нужно увеличить.
+
+namespace {
+
+const size_t kCorpusSize = 16 << 20;
+const uint64_t kDefaultMaxFileSize = 256 << 20;
+
+struct Corpus {
+    const char* name;
+    std::string (*generate)(size_t size);
+};
+
+struct Mode {
+    const char* name;
+    unsigned metrics;
+};
+
+std::string randomWord(std::mt19937& rng, const std::vector<std::string>& letters, size_t maxLength) {
+    std::string word;
+    size_t length = 1 + rng() % maxLength;
+    for (size_t i = 0; i < length; ++i) word += letters[rng() % letters.size()];
+    return word;
+}
+
+// Строки длиной около мегабайта
+std::string longLines(size_t size) {
+    std::mt19937 rng(1);
+    std::vector<std::string> letters = {"a", "b", "c", "d", "e", "f", "g", "h"};
+    std::string text;
+    while (text.size() < size) {
+        text += randomWord(rng, letters, 12);
+        text += (rng() % (1 << 17) == 0) ? '\n' : ' ';
+    }
+    text.resize(size);
+    return text;
+}
+
+// Одни переводы строк
+std::string emptyLines(size_t size) {
+    return std::string(size, '\n');
+}
+
+// Короткие ASCII-слова, строки около 80 символов
+std::string asciiWords(size_t size) {
+    std::mt19937 rng(2);
+    std::vector<std::string> letters;
+    for (char c = 'a'; c <= 'z'; ++c) letters.emplace_back(1, c);
+    std::string text;
+    size_t lineStart = 0;
+    while (text.size() < size) {
+        text += randomWord(rng, letters, 8);
+        if (text.size() - lineStart > 80) {
+            text += '\n';
+            lineStart = text.size();
+        } else {
+            text += ' ';
+        }
+    }
+    text.resize(size);
+    return text;
+}
+
+// Кириллица в UTF-8: по два байта на букву
+std::string cyrillicWords(size_t size) {
+    std::mt19937 rng(3);
+    std::vector<std::string> letters = {"а", "б", "в", "г", "д", "е", "ж", "з", "и", "к", "л", "м",
+                                        "н", "о", "п", "р", "с", "т", "у", "ф", "х", "ц", "ч", "я"};
+    std::string text;
+    while (text.size() < size) {
+        text += randomWord(rng, letters, 10);
+        text += (rng() % 12 == 0) ? '\n' : ' ';
+    }
+    text.resize(size);
+    return text;
+}
+
+// Равномерно случайные байты
+std::string binaryNoise(size_t size) {
+    std::mt19937 rng(4);
+    std::string text(size, '\0');
+    for (char& c : text) c = char(rng());
+    return text;
+}
+
+const Corpus kCorpora[] = {
+    {"long_lines", longLines},
+    {"empty_lines", emptyLines},
+    {"ascii_words", asciiWords},
+    {"cyrillic", cyrillicWords},
+    {"binary", binaryNoise},
+};
+
+const Mode kModes[] = {
+    {"-l", kLines},
+    {"-w", kWords},
+    {"-c", kChars},
+    {"-lwc", kAllMetrics},
+};
+
+const char* const kLevels[] = {"scalar", "ssse3", "avx2", "avx512"};
+
+// Ядро на данных в памяти: чистая скорость классификации байт
+void countInMemory(benchmark::State& state, const std::string* text, CountKernel kernel, unsigned metrics) {
+    useKernel(metrics, kernel);
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(text->data());
+    for (auto _ : state) {
+        CountState counted;
+        countBytes(data, text->size(), counted);
+        benchmark::DoNotOptimize(counted);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text->size()));
+}
+
+// То же со своим набором разделителей, как при --delimiters
+void countWithDelimiters(benchmark::State& state, const std::string* text, std::string set, std::string level) {
+    useDelimiters(set);
+    countInMemory(state, text, selectKernel(kWords, level), kWords);
+    useDefaultDelimiters();
+}
+
+// Полный путь через файл: open, mmap, подсказки ядру и подсчёт
+void countOnDisk(benchmark::State& state, std::string path, uint64_t size, unsigned metrics) {
+    useKernel(metrics, selectKernel(metrics, ""));
+    for (auto _ : state) {
+        Counts counts;
+        if (!countFile(path, 1, counts)) {
+            state.SkipWithError("cannot read corpus file");
+            return;
+        }
+        benchmark::DoNotOptimize(counts);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(size));
+}
+
+std::string writeCorpusFile(const std::string& text, uint64_t size) {
+    const char* tmp = getenv("TMPDIR");
+    std::string path = std::string(tmp ? tmp : "/tmp") + "/wordcount_bench_" + std::to_string(getpid())
+                     + "_" + std::to_string(size);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    for (uint64_t written = 0; written < size; written += text.size()) {
+        file.write(text.data(), std::streamsize(std::min<uint64_t>(text.size(), size - written)));
+    }
+    return file ? path : std::string();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string> corpora;
+    for (const Corpus& corpus : kCorpora) corpora.push_back(corpus.generate(kCorpusSize));
+
+    for (size_t i = 0; i < corpora.size(); ++i) {
+        for (const char* level : kLevels) {
+            if (!kernelSupported(level)) continue;
+            for (const Mode& mode : kModes) {
+                std::string name = std::string("kernel/") + kCorpora[i].name + "/" + level + "/" + mode.name;
+                CountKernel kernel = selectKernel(mode.metrics, level);
+                benchmark::RegisterBenchmark(name.c_str(), countInMemory, &corpora[i], kernel, mode.metrics);
+            }
+        }
+    }
+
+    for (const char* level : kLevels) {
+        if (!kernelSupported(level)) continue;
+        std::string name = std::string("delimiters/csv/") + level + "/-w";
+        benchmark::RegisterBenchmark(name.c_str(), countWithDelimiters, &corpora[2], std::string(",;\n"), level);
+    }
+
+    uint64_t maxFileSize = kDefaultMaxFileSize;
+    if (const char* limit = getenv("WORDCOUNT_BENCH_MAX_SIZE")) maxFileSize = strtoull(limit, nullptr, 10);
+
+    std::vector<std::string> files;
+    const std::string& text = corpora[2];
+    for (uint64_t size = 1 << 10; size <= maxFileSize; size *= 32) {
+        std::string path = writeCorpusFile(text, size);
+        if (path.empty()) continue;
+        files.push_back(path);
+        for (const Mode& mode : kModes) {
+            std::string name = "file/" + std::to_string(size) + "/" + mode.name;
+            benchmark::RegisterBenchmark(name.c_str(), countOnDisk, path, size, mode.metrics);
+        }
+        std::string name = "file/" + std::to_string(size) + "/-b";
+        benchmark::RegisterBenchmark(name.c_str(), countOnDisk, path, size, 0u);
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (!benchmark::ReportUnrecognizedArguments(argc, argv)) benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    for (const std::string& path : files) remove(path.c_str());
+
+    return 0;
+}
@@ -0,0 +1,414 @@
+﻿#include <lib/wordcount.h>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+
+// Сколько файлов на поток может одновременно ждать вывода
+const size_t kFilesInFlight = 64;
+
+// Раз в секунду печатает в stderr объём прочитанного и скорость чтения.
+// Работает в отдельном потоке, пока жив объект.
+class ProgressReporter {
+public:
+    explicit ProgressReporter(bool enabled) {
+        if (enabled) reporter = std::thread(&ProgressReporter::run, this);
+    }
+
+    ~ProgressReporter() {
+        if (!reporter.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        reporter.join();
+    }
+
+private:
+    void run() {
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point start = Clock::now();
+        Clock::time_point last = start;
+        uint64_t lastBytes = 0;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            bool finished = wake.wait_for(lock, std::chrono::seconds(1), [this] { return stopping; });
+
+            Clock::time_point now = Clock::now();
+            uint64_t bytes = processedBytes();
+            // в конце печатается средняя скорость, в процессе — за последний интервал
+            double seconds = std::chrono::duration<double>(now - (finished ? start : last)).count();
+            double rate = (bytes - (finished ? 0 : lastBytes)) / std::max(seconds, 1e-9);
+
+            std::cerr << "\r" << std::fixed << std::setprecision(1)
+                      << bytes / 1048576.0 << " МиБ, " << rate / 1048576.0 << " МиБ/с   ";
+            if (finished) {
+                std::cerr << std::endl;
+                return;
+            }
+            last = now;
+            lastBytes = bytes;
+        }
+    }
+
+    std::thread reporter;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+
+// Пул потоков с перехватом работы. У каждого потока своя очередь задач:
+// свои задачи он берёт с головы, а опустев, забирает задачи с хвоста
+// чужих очередей. Задача — индекс входного файла.
+class WorkStealingPool {
+public:
+    WorkStealingPool(int threads, std::function<void(size_t)> task)
+        : task(std::move(task)) {
+        for (int i = 0; i < threads; ++i) queues.emplace_back(new Queue);
+        for (int i = 0; i < threads; ++i) workers.emplace_back(&WorkStealingPool::run, this, size_t(i));
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) worker.join();
+    }
+
+    void submit(size_t index) {
+        Queue& queue = *queues[index % queues.size()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.items.push_back(index);
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            pending++;
+        }
+        wake.notify_one();
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> items;
+    };
+
+    bool tryPop(size_t self, size_t& index) {
+        for (size_t k = 0; k < queues.size(); ++k) {
+            Queue& queue = *queues[(self + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.items.empty()) continue;
+            if (k == 0) {
+                index = queue.items.front();
+                queue.items.pop_front();
+            } else {
+                index = queue.items.back();
+                queue.items.pop_back();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void run(size_t self) {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(sleepMutex);
+                wake.wait(lock, [this] { return stopping || pending > 0; });
+                if (pending == 0) return;
+                pending--;
+            }
+            // pending учитывает задачу до её попадания к нам, поэтому она найдётся
+            size_t index;
+            while (!tryPop(self, index)) std::this_thread::yield();
+            task(index);
+        }
+    }
+
+    std::function<void(size_t)> task;
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    size_t pending = 0;
+    bool stopping = false;
+};
+
+struct Options {
+    bool showLines = false;
+    bool showWords = false;
+    bool showBytes = false;
+    bool showChars = false;
+    int threads = 0;
+    bool progress = false;
+    std::string cachePath;
+    bool customDelimiters = false;
+    std::string delimiters;
+};
+
+// Разбирает множество разделителей из --delimiters. Поддерживаются
+// экранирования \t \n \r \v \f \s (пробел), \\ и \xHH.
+static bool parseDelimiters(const std::string& spec, std::string& set) {
+    set.clear();
+    for (size_t i = 0; i < spec.size(); ++i) {
+        if (spec[i] != '\\') {
+            set += spec[i];
+            continue;
+        }
+        if (++i == spec.size()) return false;
+        switch (spec[i]) {
+            case 't': set += '\t'; break;
+            case 'n': set += '\n'; break;
+            case 'r': set += '\r'; break;
+            case 'v': set += '\v'; break;
+            case 'f': set += '\f'; break;
+            case 's': set += ' '; break;
+            case '\\': set += '\\'; break;
+            case 'x': {
+                if (i + 2 >= spec.size() || !isxdigit(static_cast<unsigned char>(spec[i + 1]))
+                    || !isxdigit(static_cast<unsigned char>(spec[i + 2]))) {
+                    return false;
+                }
+                set += char(strtol(spec.substr(i + 1, 2).c_str(), nullptr, 16));
+                i += 2;
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return !set.empty();
+}
+
+// Описание множества разделителей для заголовка кэша
+static std::string delimitersTag(const Options& options) {
+    if (!options.customDelimiters) return "whitespace";
+
+    std::string sorted = options.delimiters;
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    static const char* digits = "0123456789abcdef";
+    std::string tag = "delimiters=";
+    for (char c : sorted) {
+        tag += digits[static_cast<unsigned char>(c) >> 4];
+        tag += digits[static_cast<unsigned char>(c) & 0xF];
+    }
+    return tag;
+}
+
+static void printCounts(const Options& options, const Counts& counts, const std::string& name) {
+    const char* separator = "";
+    auto column = [&separator](uint64_t value) {
+        std::cout << separator << value;
+        separator = " ";
+    };
+
+    if (options.showLines) column(counts.lines);
+    if (options.showWords) column(counts.words);
+    if (options.showBytes) column(counts.bytes);
+    if (options.showChars) column(counts.chars);
+
+    // для стандартного ввода без аргументов имя не печатается
+    if (!name.empty()) std::cout << separator << name;
+    std::cout << "\n";
+}
+
+static void printUsage() {
+    std::cout << "Использование: WordCount.exe [опции] [файл1 файл2 ...]\n"
+              << "Без файлов или с файлом \"-\" читается стандартный ввод\n"
+              << "Файлы .gz и .zst считаются в распакованном виде\n"
+              << "  -l  строки, -w  слова, -b  байты, -c  символы UTF-8\n"
+              << "  -j N        число потоков\n"
+              << "  --progress  печатать в stderr объём и скорость чтения\n"
+              << "  --cache ФАЙЛ  хранить результаты между запусками\n"
+              << "  --delimiters НАБОР  байты-разделители слов вместо пробельных символов,\n"
+              << "                      например ',\\n' (экранирования \\t \\n \\r \\v \\f \\s \\\\ \\xHH)\n";
+}
+
+static void addCounts(Counts& total, const Counts& counts) {
+    total.lines += counts.lines;
+    total.words += counts.words;
+    total.bytes += counts.bytes;
+    total.chars += counts.chars;
+}
+
+// Считает файлы параллельно и печатает результаты в порядке аргументов.
+// В работе одновременно не больше окна из kFilesInFlight файлов на поток,
+// так что память не растёт с числом входных файлов.
+static void countFiles(const Options& options, char** files, size_t count) {
+    struct Slot {
+        Counts counts;
+        bool ok = false;
+        bool ready = false;
+    };
+
+    size_t window = kFilesInFlight * size_t(options.threads);
+    std::vector<Slot> slots(std::min(window, count));
+    std::mutex doneMutex;
+    std::condition_variable done;
+
+    Counts total;
+    size_t submitted = 0;
+    {
+        WorkStealingPool pool(options.threads, [&](size_t index) {
+            Slot& slot = slots[index % slots.size()];
+            slot.ok = countFile(files[index], 1, slot.counts);
+            {
+                std::lock_guard<std::mutex> lock(doneMutex);
+                slot.ready = true;
+            }
+            done.notify_one();
+        });
+
+        for (size_t next = 0; next < count; ++next) {
+            while (submitted < count && submitted < next + slots.size()) pool.submit(submitted++);
+
+            Slot& slot = slots[next % slots.size()];
+            {
+                std::unique_lock<std::mutex> lock(doneMutex);
+                done.wait(lock, [&slot] { return slot.ready; });
+                slot.ready = false;
+            }
+
+            if (!slot.ok) {
+                std::cout << "Не удалось открыть файл: " << files[next] << "\n";
+                continue;
+            }
+            printCounts(options, slot.counts, files[next]);
+            addCounts(total, slot.counts);
+        }
+    }
+
+    printCounts(options, total, "total");
+}
+
+int main(int argc, char* argv[]) {
+    
+    setlocale(LC_ALL, "Rus");
+    
+    Options options;
+
+    int fileStartIndex = argc;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--progress") {
+            options.progress = true;
+        } else if (arg == "--cache" || arg.rfind("--cache=", 0) == 0) {
+            // --cache ФАЙЛ или --cache=ФАЙЛ; пустое значение после = — ошибка,
+            // а не повод взять следующий аргумент
+            if (arg != "--cache") options.cachePath = arg.substr(8);
+            else if (i + 1 < argc) options.cachePath = argv[++i];
+            if (options.cachePath.empty()) {
+                std::cout << "Не указан файл кэша\n";
+                return 1;
+            }
+        } else if (arg == "--delimiters" || arg.rfind("--delimiters=", 0) == 0) {
+            // --delimiters НАБОР или --delimiters=НАБОР
+            std::string spec;
+            if (arg.size() > 12) spec = arg.substr(13);
+            else if (i + 1 < argc) spec = argv[++i];
+            if (!parseDelimiters(spec, options.delimiters)) {
+                std::cout << "Некорректный набор разделителей: " << spec << "\n";
+                return 1;
+            }
+            options.customDelimiters = true;
+        } else if (arg[0] == '-' && arg != kStdinName) {
+            for (size_t j = 1; j < arg.size(); j++) {
+                if (arg[j] == 'h') {
+                    printUsage();
+                    return 0;
+                }
+                else if (arg[j] == 'l') options.showLines = true;
+                else if (arg[j] == 'w') options.showWords = true;
+                else if (arg[j] == 'b') options.showBytes = true;
+                else if (arg[j] == 'c') options.showChars = true;
+                else if (arg[j] == 'j') {
+                    // -j N или -jN: число рабочих потоков
+                    std::string value = arg.substr(j + 1);
+                    if (value.empty() && i + 1 < argc) value = argv[++i];
+                    options.threads = atoi(value.c_str());
+                    if (options.threads < 1) {
+                        std::cout << "Некорректное число потоков: " << value << "\n";
+                        return 1;
+                    }
+                    break;
+                }
+            }
+        } else {
+            fileStartIndex = i;
+            break;
+        }
+    }
+
+    if (!options.showLines && !options.showWords && !options.showBytes && !options.showChars) {
+        options.showLines = true;
+        options.showWords = true;
+        options.showBytes = true;
+    }
+
+    unsigned metrics = 0;
+    if (options.showLines) metrics |= kLines;
+    if (options.showWords) metrics |= kWords;
+    if (options.showChars) metrics |= kChars;
+
+    if (options.customDelimiters) useDelimiters(options.delimiters);
+
+    std::unique_ptr<ResultCache> cache;
+    if (!options.cachePath.empty()) {
+        cache.reset(new ResultCache(options.cachePath, delimitersTag(options)));
+        cache->load();
+        useResultCache(cache.get());
+        metrics = kAllMetrics;
+    }
+    useKernel(metrics, selectKernel(metrics));
+
+    if (options.threads == 0) {
+        options.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    ProgressReporter progress(options.progress);
+
+    size_t fileCount = size_t(argc - fileStartIndex);
+    if (fileCount == 0) {
+        Counts counts;
+        if (!countStdin(counts)) {
+            std::cout << "Не удалось прочитать стандартный ввод\n";
+            return 1;
+        }
+        printCounts(options, counts, "");
+    } else if (fileCount == 1) {
+        // единственный файл делится между потоками по участкам
+        std::string filename = argv[fileStartIndex];
+        Counts counts;
+        if (!countFile(filename, options.threads, counts)) {
+            std::cout << "Не удалось открыть файл: " << filename << "\n";
+        } else {
+            printCounts(options, counts, filename);
+        }
+    } else {
+        countFiles(options, argv + fileStartIndex, fileCount);
+    }
+
+    if (cache && !cache->save()) {
+        std::cout << "Не удалось сохранить кэш: " << options.cachePath << "\n";
+    }
+
+    return 0;
+}
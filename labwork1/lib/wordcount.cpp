@@ -0,0 +1,953 @@
+#include "wordcount.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#ifdef WORDCOUNT_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef WORDCOUNT_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+const char* const kStdinName = "-";
+
+// Размер буфера для стандартного ввода и файлов, которые не удалось
+// отобразить в память. Больше памяти на поток чтение не занимает.
+const size_t kReadBufferSize = 4 << 20;
+// Меньшие участки не выгодно раздавать отдельным потокам
+const size_t kMinParallelChunk = 8 << 20;
+// Отображённый файл считается окнами такого размера: следующее окно заранее
+// запрашивается у ядра, и после каждого окна обновляется счётчик прогресса
+const size_t kReadaheadWindow = 64 << 20;
+// Распакованные данные передаются на подсчёт через кольцо из
+// kDecompressBuffers буферов; сжатый файл читается порциями kCompressedInputSize
+const size_t kDecompressBuffers = 4;
+const size_t kDecompressBufferSize = 1 << 20;
+const size_t kCompressedInputSize = 256 << 10;
+// Сколько байт перед концом файла хэширует кэш, чтобы узнать дописанный файл
+const size_t kFingerprintSize = 4 << 10;
+
+// Классы байт для поиска границ слов. separator — прямая таблица для
+// скалярного кода. Векторные ядра проверяют байт c двумя 16-элементными
+// таблицами по полубайтам: c — разделитель, если (low[c & 0xF] & high[c >> 4]) != 0.
+// Каждому различному набору младших полубайт (строке таблицы 16x16) отводится
+// свой бит, поэтому так представимы множества не более чем с 8 различными строками.
+struct DelimiterTable {
+    bool separator[256] = {};
+    uint8_t low[16] = {};
+    uint8_t high[16] = {};
+    bool vectorizable = true;
+};
+
+static constexpr DelimiterTable makeDelimiterTable(const char* set, size_t size) {
+    DelimiterTable table;
+    for (size_t i = 0; i < size; ++i) table.separator[static_cast<unsigned char>(set[i])] = true;
+
+    uint16_t rows[8] = {};
+    int rowCount = 0;
+    for (int high = 0; high < 16; ++high) {
+        uint16_t row = 0;
+        for (int low = 0; low < 16; ++low) {
+            if (table.separator[high * 16 + low]) row |= uint16_t(1 << low);
+        }
+        if (row == 0) continue;
+
+        int bit = 0;
+        while (bit < rowCount && rows[bit] != row) ++bit;
+        if (bit == rowCount) {
+            if (rowCount == 8) {
+                table.vectorizable = false;
+                return table;
+            }
+            rows[rowCount++] = row;
+        }
+
+        table.high[high] |= uint8_t(1 << bit);
+        for (int low = 0; low < 16; ++low) {
+            if ((row >> low) & 1) table.low[low] |= uint8_t(1 << bit);
+        }
+    }
+
+    return table;
+}
+
+// Пробельные символы ASCII, как у isspace в локали "C"
+static constexpr DelimiterTable kWhitespace = makeDelimiterTable(" \t\n\v\f\r", 6);
+
+static DelimiterTable delimiters = kWhitespace;
+
+static bool isSeparator(unsigned char c) {
+    return delimiters.separator[c];
+}
+
+// Байт начинает символ UTF-8, если он не продолжающий (10xxxxxx)
+static bool isCharStart(unsigned char c) {
+    return (c & 0xC0) != 0x80;
+}
+
+template <unsigned Metrics>
+static void countBlockScalar(const unsigned char* data, size_t size, CountState& state) {
+    uint64_t lines = 0;
+    uint64_t words = 0;
+    uint64_t chars = 0;
+    bool inWord = state.inWord;
+    const bool* separators = delimiters.separator;
+
+    for (size_t i = 0; i < size; ++i) {
+        unsigned char c = data[i];
+        if constexpr ((Metrics & kLines) != 0) lines += (c == '\n');
+        if constexpr ((Metrics & kWords) != 0) {
+            bool separator = separators[c];
+            words += (!separator && !inWord);
+            inWord = !separator;
+        }
+        if constexpr ((Metrics & kChars) != 0) chars += isCharStart(c);
+    }
+
+    state.counts.lines += lines;
+    state.counts.words += words;
+    state.counts.bytes += size;
+    state.counts.chars += chars;
+    state.inWord = inWord;
+    if (size > 0) state.lastByte = data[size - 1];
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// Векторные ядра обрабатывают блоки по 64 байта: для каждого блока строятся
+// битовые маски разделителей, переводов строки и начал символов UTF-8, а слова
+// считаются как позиции "не разделитель, перед которым разделитель". Хвост
+// короче блока досчитывает скалярное ядро, поэтому результаты совпадают побитово.
+const size_t kSimdBlock = 64;
+
+struct BlockMasks {
+    uint64_t separators = 0;
+    uint64_t newlines = 0;
+    uint64_t charStarts = 0;
+};
+
+template <unsigned Metrics>
+struct SimdTally {
+    uint64_t lines = 0;
+    uint64_t words = 0;
+    uint64_t chars = 0;
+    bool inWord = false;
+
+    void add(const BlockMasks& masks) {
+        if constexpr ((Metrics & kLines) != 0) lines += __builtin_popcountll(masks.newlines);
+        if constexpr ((Metrics & kWords) != 0) {
+            uint64_t prevSeparators = (masks.separators << 1) | (inWord ? 0 : 1);
+            words += __builtin_popcountll(~masks.separators & prevSeparators);
+            inWord = !(masks.separators >> 63);
+        }
+        if constexpr ((Metrics & kChars) != 0) chars += __builtin_popcountll(masks.charStarts);
+    }
+};
+
+template <unsigned Metrics>
+static void finishSimd(const unsigned char* data, size_t size, size_t done,
+                       const SimdTally<Metrics>& tally, CountState& state) {
+    state.counts.lines += tally.lines;
+    state.counts.words += tally.words;
+    state.counts.bytes += done;
+    state.counts.chars += tally.chars;
+    state.inWord = tally.inWord;
+    if (done > 0) state.lastByte = data[done - 1];
+    countBlockScalar<Metrics>(data + done, size - done, state);
+}
+
+template <unsigned Metrics>
+__attribute__((target("ssse3")))
+static void countBlockSsse3(const unsigned char* data, size_t size, CountState& state) {
+    const __m128i lowTable = _mm_loadu_si128(reinterpret_cast<const __m128i*>(delimiters.low));
+    const __m128i highTable = _mm_loadu_si128(reinterpret_cast<const __m128i*>(delimiters.high));
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i newline = _mm_set1_epi8('\n');
+    // Продолжающие байты 0x80..0xBF как знаковые лежат в [-128, -65],
+    // так что начало символа — это байт, знаково больший -65
+    const __m128i lastContinuation = _mm_set1_epi8(int8_t(0xBF));
+
+    SimdTally<Metrics> tally;
+    tally.inWord = state.inWord;
+    size_t done = 0;
+
+    for (; done + kSimdBlock <= size; done += kSimdBlock) {
+        BlockMasks masks;
+        for (int part = 0; part < 4; ++part) {
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + done + part * 16));
+            if constexpr ((Metrics & kWords) != 0) {
+                __m128i low = _mm_shuffle_epi8(lowTable, _mm_and_si128(c, nibble));
+                __m128i high = _mm_shuffle_epi8(highTable, _mm_and_si128(_mm_srli_epi16(c, 4), nibble));
+                __m128i word = _mm_cmpeq_epi8(_mm_and_si128(low, high), zero);
+                uint32_t sep = ~uint32_t(_mm_movemask_epi8(word)) & 0xFFFF;
+                masks.separators |= uint64_t(sep) << (part * 16);
+            }
+            if constexpr ((Metrics & kLines) != 0) {
+                __m128i nl = _mm_cmpeq_epi8(c, newline);
+                masks.newlines |= uint64_t(uint32_t(_mm_movemask_epi8(nl))) << (part * 16);
+            }
+            if constexpr ((Metrics & kChars) != 0) {
+                __m128i starts = _mm_cmpgt_epi8(c, lastContinuation);
+                masks.charStarts |= uint64_t(uint32_t(_mm_movemask_epi8(starts))) << (part * 16);
+            }
+        }
+        tally.add(masks);
+    }
+
+    finishSimd(data, size, done, tally, state);
+}
+
+template <unsigned Metrics>
+__attribute__((target("avx2,popcnt")))
+static void countBlockAvx2(const unsigned char* data, size_t size, CountState& state) {
+    const __m256i lowTable = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(delimiters.low)));
+    const __m256i highTable = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(delimiters.high)));
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i lastContinuation = _mm256_set1_epi8(int8_t(0xBF));
+
+    SimdTally<Metrics> tally;
+    tally.inWord = state.inWord;
+    size_t done = 0;
+
+    for (; done + kSimdBlock <= size; done += kSimdBlock) {
+        BlockMasks masks;
+        for (int part = 0; part < 2; ++part) {
+            __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + done + part * 32));
+            if constexpr ((Metrics & kWords) != 0) {
+                __m256i low = _mm256_shuffle_epi8(lowTable, _mm256_and_si256(c, nibble));
+                __m256i high = _mm256_shuffle_epi8(highTable, _mm256_and_si256(_mm256_srli_epi16(c, 4), nibble));
+                __m256i word = _mm256_cmpeq_epi8(_mm256_and_si256(low, high), zero);
+                uint32_t sep = ~uint32_t(_mm256_movemask_epi8(word));
+                masks.separators |= uint64_t(sep) << (part * 32);
+            }
+            if constexpr ((Metrics & kLines) != 0) {
+                __m256i nl = _mm256_cmpeq_epi8(c, newline);
+                masks.newlines |= uint64_t(uint32_t(_mm256_movemask_epi8(nl))) << (part * 32);
+            }
+            if constexpr ((Metrics & kChars) != 0) {
+                __m256i starts = _mm256_cmpgt_epi8(c, lastContinuation);
+                masks.charStarts |= uint64_t(uint32_t(_mm256_movemask_epi8(starts))) << (part * 32);
+            }
+        }
+        tally.add(masks);
+    }
+
+    finishSimd(data, size, done, tally, state);
+}
+
+template <unsigned Metrics>
+__attribute__((target("avx512f,avx512bw,popcnt")))
+static void countBlockAvx512(const unsigned char* data, size_t size, CountState& state) {
+    const __m512i lowTable = _mm512_broadcast_i32x4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(delimiters.low)));
+    const __m512i highTable = _mm512_broadcast_i32x4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(delimiters.high)));
+    const __m512i nibble = _mm512_set1_epi8(0x0F);
+    const __m512i newline = _mm512_set1_epi8('\n');
+    const __m512i lastContinuation = _mm512_set1_epi8(int8_t(0xBF));
+
+    SimdTally<Metrics> tally;
+    tally.inWord = state.inWord;
+    size_t done = 0;
+
+    for (; done + kSimdBlock <= size; done += kSimdBlock) {
+        __m512i c = _mm512_loadu_si512(data + done);
+        BlockMasks masks;
+        if constexpr ((Metrics & kWords) != 0) {
+            __m512i low = _mm512_shuffle_epi8(lowTable, _mm512_and_si512(c, nibble));
+            __m512i high = _mm512_shuffle_epi8(highTable, _mm512_and_si512(_mm512_srli_epi16(c, 4), nibble));
+            masks.separators = _mm512_test_epi8_mask(low, high);
+        }
+        if constexpr ((Metrics & kLines) != 0) masks.newlines = _mm512_cmpeq_epi8_mask(c, newline);
+        if constexpr ((Metrics & kChars) != 0) masks.charStarts = _mm512_cmpgt_epi8_mask(c, lastContinuation);
+        tally.add(masks);
+    }
+
+    finishSimd(data, size, done, tally, state);
+}
+
+#endif
+
+// Таблицы ядер, индекс — набор метрик
+const CountKernel kScalarKernels[] = {
+    countBlockScalar<0>, countBlockScalar<1>, countBlockScalar<2>, countBlockScalar<3>,
+    countBlockScalar<4>, countBlockScalar<5>, countBlockScalar<6>, countBlockScalar<7>,
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+const CountKernel kSsse3Kernels[] = {
+    countBlockSsse3<0>, countBlockSsse3<1>, countBlockSsse3<2>, countBlockSsse3<3>,
+    countBlockSsse3<4>, countBlockSsse3<5>, countBlockSsse3<6>, countBlockSsse3<7>,
+};
+const CountKernel kAvx2Kernels[] = {
+    countBlockAvx2<0>, countBlockAvx2<1>, countBlockAvx2<2>, countBlockAvx2<3>,
+    countBlockAvx2<4>, countBlockAvx2<5>, countBlockAvx2<6>, countBlockAvx2<7>,
+};
+const CountKernel kAvx512Kernels[] = {
+    countBlockAvx512<0>, countBlockAvx512<1>, countBlockAvx512<2>, countBlockAvx512<3>,
+    countBlockAvx512<4>, countBlockAvx512<5>, countBlockAvx512<6>, countBlockAvx512<7>,
+};
+#endif
+
+bool kernelSupported(const std::string& level) {
+    if (level == "scalar") return true;
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (level == "ssse3") return __builtin_cpu_supports("ssse3");
+    if (level == "avx2") return __builtin_cpu_supports("avx2");
+    if (level == "avx512") return __builtin_cpu_supports("avx512bw");
+#endif
+    return false;
+}
+
+CountKernel selectKernel(unsigned metrics, const std::string& limit) {
+    if (limit == "scalar") return kScalarKernels[metrics];
+    // слишком сложное множество разделителей не ложится на таблицы полубайт
+    if ((metrics & kWords) != 0 && !delimiters.vectorizable) return kScalarKernels[metrics];
+
+#if defined(__x86_64__) || defined(__i386__)
+    if (limit.empty() || limit == "avx512") {
+        if (kernelSupported("avx512")) return kAvx512Kernels[metrics];
+    }
+    if (limit.empty() || limit == "avx512" || limit == "avx2") {
+        if (kernelSupported("avx2")) return kAvx2Kernels[metrics];
+    }
+    if (kernelSupported("ssse3")) return kSsse3Kernels[metrics];
+#endif
+
+    return kScalarKernels[metrics];
+}
+
+// Ядро выбирается один раз при запуске по CPUID и набору метрик. Переменная
+// окружения WORDCOUNT_KERNEL позволяет понизить уровень, например чтобы
+// сравнить результаты с эталонным скалярным ядром.
+CountKernel selectKernel(unsigned metrics) {
+    const char* forced = getenv("WORDCOUNT_KERNEL");
+    return selectKernel(metrics, forced ? forced : "");
+}
+
+// Задаются через useKernel после разбора опций
+static unsigned selectedMetrics = kAllMetrics;
+static CountKernel countBlock = kScalarKernels[kAllMetrics];
+
+static std::atomic<uint64_t> bytesDone{0};
+
+void useDelimiters(const std::string& set) {
+    delimiters = makeDelimiterTable(set.data(), set.size());
+}
+
+void useDefaultDelimiters() {
+    delimiters = kWhitespace;
+}
+
+void useKernel(unsigned metrics, CountKernel kernel) {
+    selectedMetrics = metrics;
+    countBlock = kernel;
+}
+
+uint64_t processedBytes() {
+    return bytesDone.load(std::memory_order_relaxed);
+}
+
+void countBytes(const unsigned char* data, size_t size, CountState& state) {
+    if (size == 0) return;
+    if (state.counts.bytes == 0) state.startsInWord = !isSeparator(data[0]);
+    countBlock(data, size, state);
+    bytesDone.fetch_add(size, std::memory_order_relaxed);
+}
+// Присоединяет к left состояние участка, идущего в файле сразу за ним.
+// Слово, разрезанное границей участков, посчитано в обоих, поэтому вычитается.
+void mergeStates(CountState& left, const CountState& right) {
+    if (right.counts.bytes == 0) return;
+    if (left.counts.bytes == 0) {
+        left = right;
+        return;
+    }
+
+    left.counts.lines += right.counts.lines;
+    left.counts.words += right.counts.words;
+    if (left.inWord && right.startsInWord) left.counts.words--;
+    left.counts.bytes += right.counts.bytes;
+    left.counts.chars += right.counts.chars;
+    left.inWord = right.inWord;
+    left.lastByte = right.lastByte;
+}
+
+Counts finishCount(const CountState& state) {
+    Counts result = state.counts;
+    // последняя строка без перевода строки тоже считается строкой
+    if (result.bytes > 0 && state.lastByte != '\n') result.lines++;
+    return result;
+}
+
+static const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+
+// Считает отображённый участок окнами, заранее подкачивая следующее окно
+static void countMappedRange(const unsigned char* data, size_t size, CountState& state) {
+    for (size_t done = 0; done < size; done += kReadaheadWindow) {
+        size_t window = std::min(kReadaheadWindow, size - done);
+        size_t next = done + window;
+        if (next < size) {
+            // madvise требует адрес, выровненный по странице
+            uintptr_t ahead = uintptr_t(data + next) & ~uintptr_t(pageSize - 1);
+            madvise(reinterpret_cast<void*>(ahead), std::min(kReadaheadWindow, size - next), MADV_WILLNEED);
+        }
+        countBytes(data + done, window, state);
+    }
+}
+
+// Делит данные на threads равных участков, считает каждый в своём потоке
+// и объединяет частичные результаты по порядку
+static void countParallel(const unsigned char* data, size_t size, int threads, CountState& state) {
+    size_t chunks = std::min(size_t(threads), std::max<size_t>(1, size / kMinParallelChunk));
+    size_t chunkSize = size / chunks;
+
+    std::vector<CountState> partial(chunks);
+    std::vector<std::thread> workers;
+    for (size_t k = 1; k < chunks; ++k) {
+        size_t begin = k * chunkSize;
+        size_t end = (k + 1 == chunks) ? size : begin + chunkSize;
+        workers.emplace_back(countMappedRange, data + begin, end - begin, std::ref(partial[k]));
+    }
+    countMappedRange(data, chunkSize, partial[0]);
+
+    for (std::thread& worker : workers) worker.join();
+    for (const CountState& part : partial) mergeStates(state, part);
+}
+
+// Считает файл с позиции offset до конца fileSize. Нулевой размер ещё не
+// значит пустой файл: у файлов procfs и sysfs он нулевой, а данные есть,
+// поэтому такой файл оставляется потоковому чтению.
+static bool countMapped(int fd, uint64_t offset, uint64_t fileSize, int threads, CountState& state) {
+    if (fileSize == 0) return false;
+    if (offset >= fileSize) return true;
+    // отображение начинается с границы страницы
+    uint64_t mapOffset = offset & ~uint64_t(pageSize - 1);
+    // файл больше адресного пространства читается потоком
+    if (fileSize - mapOffset > SIZE_MAX) return false;
+    size_t mapSize = size_t(fileSize - mapOffset);
+
+    posix_fadvise(fd, off_t(offset), 0, POSIX_FADV_SEQUENTIAL);
+
+    void* addr = mmap(nullptr, mapSize, PROT_READ, MAP_PRIVATE, fd, off_t(mapOffset));
+    if (addr == MAP_FAILED) return false;
+
+    const unsigned char* data = static_cast<const unsigned char*>(addr) + (offset - mapOffset);
+    size_t size = size_t(fileSize - offset);
+    madvise(addr, mapSize, MADV_SEQUENTIAL);
+    if (threads > 1) {
+        countParallel(data, size, threads, state);
+    } else {
+        countMappedRange(data, size, state);
+    }
+    munmap(addr, mapSize);
+
+    return true;
+}
+
+static bool countBuffered(int fd, CountState& state) {
+    thread_local std::vector<unsigned char> buffer(kReadBufferSize);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    while (true) {
+        ssize_t n = read(fd, buffer.data(), buffer.size());
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (n == 0) return true;
+        countBytes(buffer.data(), size_t(n), state);
+    }
+}
+
+// Стандартный ввод всегда читается потоком: даже если это перенаправленный
+// файл, позиция в нём может быть не в начале
+bool countStdin(Counts& result) {
+#ifdef F_SETPIPE_SZ
+    // больший буфер канала — меньше переключений между писателем и нами
+    fcntl(STDIN_FILENO, F_SETPIPE_SZ, int(1 << 20));
+#endif
+    CountState state;
+    bool ok = countBuffered(STDIN_FILENO, state);
+    result = finishCount(state);
+
+    return ok;
+}
+
+// Первая строка любого файла кэша, за ней версия формата и tag
+static const char* const kCacheMagic = "WordCount cache";
+static const char* const kCacheVersion = "v2";
+
+ResultCache::ResultCache(std::string path, std::string tag)
+    : path(std::move(path))
+    , header(std::string(kCacheMagic) + " " + kCacheVersion + " " + tag) {
+}
+
+void ResultCache::load() {
+    std::ifstream file(path);
+    std::string line;
+    if (!getline(file, line)) return;
+    // кэш другой версии или с другими разделителями можно заменить, а чужой файл — нет
+    if (line.rfind(std::string(kCacheMagic) + " ", 0) != 0) {
+        foreign = true;
+        return;
+    }
+    if (line != header) return;
+
+    Key key;
+    Entry entry;
+    int startsInWord = 0;
+    int inWord = 0;
+    int lastByte = 0;
+    while (file >> key.device >> key.inode >> entry.size >> entry.mtimeSec >> entry.mtimeNsec >> entry.fingerprint
+                >> entry.state.counts.lines >> entry.state.counts.words
+                >> entry.state.counts.bytes >> entry.state.counts.chars
+                >> startsInWord >> inWord >> lastByte) {
+        entry.state.startsInWord = startsInWord != 0;
+        entry.state.inWord = inWord != 0;
+        entry.state.lastByte = static_cast<unsigned char>(lastByte);
+        entries[key] = entry;
+    }
+}
+
+// Пишет во временный файл и переименовывает, чтобы не оставить кэш недописанным
+bool ResultCache::save() const {
+    if (foreign) return false;
+
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        file << header << "\n";
+        for (const auto& [key, entry] : entries) {
+            const Counts& counts = entry.state.counts;
+            file << key.device << " " << key.inode << " " << entry.size << " "
+                 << entry.mtimeSec << " " << entry.mtimeNsec << " " << entry.fingerprint << " "
+                 << counts.lines << " " << counts.words << " " << counts.bytes << " " << counts.chars << " "
+                 << int(entry.state.startsInWord) << " " << int(entry.state.inWord) << " "
+                 << int(entry.state.lastByte) << "\n";
+        }
+        if (!file.flush()) return false;
+    }
+    return rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+bool ResultCache::find(const struct stat& st, Entry& entry) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(keyOf(st));
+    if (it == entries.end()) return false;
+    entry = it->second;
+    return true;
+}
+
+void ResultCache::store(const struct stat& st, const CountState& state, uint64_t fingerprint) {
+    Entry entry;
+    entry.size = uint64_t(st.st_size);
+    entry.mtimeSec = st.st_mtim.tv_sec;
+    entry.mtimeNsec = st.st_mtim.tv_nsec;
+    entry.fingerprint = fingerprint;
+    entry.state = state;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    entries[keyOf(st)] = entry;
+}
+
+bool ResultCache::isUnchanged(const Entry& entry, const struct stat& st) {
+    return entry.size == uint64_t(st.st_size)
+        && entry.mtimeSec == st.st_mtim.tv_sec
+        && entry.mtimeNsec == st.st_mtim.tv_nsec;
+}
+
+ResultCache::Key ResultCache::keyOf(const struct stat& st) {
+    Key key;
+    key.device = uint64_t(st.st_dev);
+    key.inode = uint64_t(st.st_ino);
+    return key;
+}
+
+static ResultCache* resultCache = nullptr;
+
+void useResultCache(ResultCache* cache) {
+    resultCache = cache;
+}
+
+// Хэш FNV-1a последних kFingerprintSize байт перед позицией end;
+// false — их не удалось прочитать
+static bool fingerprintBefore(int fd, uint64_t end, uint64_t& hash) {
+    unsigned char data[kFingerprintSize];
+    uint64_t begin = end > kFingerprintSize ? end - kFingerprintSize : 0;
+    size_t size = size_t(end - begin);
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = pread(fd, data + done, size - done, off_t(begin + done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        done += size_t(n);
+    }
+
+    hash = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < size; ++i) hash = (hash ^ data[i]) * 0x100000001B3ull;
+    return true;
+}
+
+// Подсчёт обычного файла через кэш. Если файл вырос с прошлого запуска и
+// байты перед старым концом те же, считается только хвост после
+// сохранённого размера: кэш рассчитан на журналы, в которые только дописывают.
+static bool countCached(int fd, const struct stat& st, int threads, CountState& state) {
+    // по нулевому размеру не отличить пустой файл от файла procfs: такие
+    // файлы читаются потоком и в кэш не попадают
+    if (st.st_size == 0) return false;
+
+    ResultCache::Entry cached;
+    uint64_t offset = 0;
+    if (resultCache->find(st, cached)) {
+        if (ResultCache::isUnchanged(cached, st)) {
+            state = cached.state;
+            return true;
+        }
+        uint64_t fingerprint = 0;
+        if (cached.size < uint64_t(st.st_size) && fingerprintBefore(fd, cached.size, fingerprint)
+            && fingerprint == cached.fingerprint) {
+            state = cached.state;
+            offset = cached.size;
+        }
+    }
+
+    CountState tail;
+    bool ok = countMapped(fd, offset, uint64_t(st.st_size), threads, tail);
+    if (!ok && lseek(fd, off_t(offset), SEEK_SET) >= 0) ok = countBuffered(fd, tail);
+    if (!ok) return false;
+
+    mergeStates(state, tail);
+    uint64_t fingerprint = 0;
+    if (fingerprintBefore(fd, uint64_t(st.st_size), fingerprint)) resultCache->store(st, state, fingerprint);
+
+    return true;
+}
+
+// Кольцо переиспользуемых буферов между распаковщиком и подсчётом. Распаковка
+// идёт в отдельном потоке и заполняет свободные буферы, пока подсчёт разбирает
+// уже готовые, так что в памяти никогда не больше count буферов данных.
+class BufferRing {
+public:
+    BufferRing(size_t count, size_t size)
+        : buffers(count, std::vector<unsigned char>(size))
+        , used(count, 0) {
+    }
+
+    // Для распаковщика: следующий свободный буфер (ждёт, пока он освободится)
+    std::vector<unsigned char>& acquire() {
+        std::unique_lock<std::mutex> lock(mutex);
+        spaceFreed.wait(lock, [this] { return filled < buffers.size(); });
+        return buffers[produced % buffers.size()];
+    }
+
+    void publish(size_t size) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            used[produced % buffers.size()] = size;
+            produced++;
+            filled++;
+        }
+        dataReady.notify_one();
+    }
+
+    void finish(bool ok) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = true;
+            succeeded = ok;
+        }
+        dataReady.notify_one();
+    }
+
+    // Для подсчёта: следующий заполненный буфер; false — данные кончились
+    bool next(const unsigned char*& data, size_t& size) {
+        std::unique_lock<std::mutex> lock(mutex);
+        dataReady.wait(lock, [this] { return filled > 0 || finished; });
+        if (filled == 0) return false;
+        size_t slot = consumed % buffers.size();
+        data = buffers[slot].data();
+        size = used[slot];
+        return true;
+    }
+
+    void release() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            consumed++;
+            filled--;
+        }
+        spaceFreed.notify_one();
+    }
+
+    bool ok() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return succeeded;
+    }
+
+private:
+    std::vector<std::vector<unsigned char>> buffers;
+    std::vector<size_t> used;
+    std::mutex mutex;
+    std::condition_variable dataReady;
+    std::condition_variable spaceFreed;
+    size_t produced = 0;
+    size_t consumed = 0;
+    size_t filled = 0;
+    bool finished = false;
+    bool succeeded = false;
+};
+
+enum class Compression {
+    kNone,
+    kGzip,
+    kZstd
+};
+
+static bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Сжатым считается файл с расширением .gz или .zst и подходящей сигнатурой.
+// Без нужной библиотеки такой файл считается как есть.
+static Compression detectCompression(const std::string& filename, int fd) {
+    unsigned char magic[4] = {};
+    ssize_t n = pread(fd, magic, sizeof(magic), 0);
+#ifdef WORDCOUNT_HAVE_ZLIB
+    if (endsWith(filename, ".gz") && n >= 2 && magic[0] == 0x1F && magic[1] == 0x8B) {
+        return Compression::kGzip;
+    }
+#endif
+#ifdef WORDCOUNT_HAVE_ZSTD
+    if (endsWith(filename, ".zst") && n >= 4 && magic[0] == 0x28 && magic[1] == 0xB5
+        && magic[2] == 0x2F && magic[3] == 0xFD) {
+        return Compression::kZstd;
+    }
+#endif
+    (void)filename;
+    (void)n;
+    return Compression::kNone;
+}
+
+// Читает из fd до заполнения буфера или конца файла
+static ssize_t readFull(int fd, unsigned char* data, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = read(fd, data + done, size - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) break;
+        done += size_t(n);
+    }
+    return ssize_t(done);
+}
+
+#ifdef WORDCOUNT_HAVE_ZLIB
+// Распаковывает gzip, включая файлы из нескольких склеенных частей
+static bool inflateGzip(int fd, BufferRing& ring) {
+    z_stream stream = {};
+    // 15 + 32: окно 32 КиБ и автоопределение заголовка gzip/zlib
+    if (inflateInit2(&stream, 15 + 32) != Z_OK) return false;
+
+    std::vector<unsigned char> input(kCompressedInputSize);
+    bool ok = true;
+    bool streamEnded = true;
+
+    while (ok) {
+        ssize_t n = readFull(fd, input.data(), input.size());
+        if (n < 0) {
+            ok = false;
+            break;
+        }
+        if (n == 0) break;
+
+        stream.next_in = input.data();
+        stream.avail_in = uInt(n);
+        // заполненный выход значит, что распакованные данные могли остаться
+        // внутри потока, даже если вход уже прочитан
+        bool outputFull = false;
+        while (stream.avail_in > 0 || outputFull) {
+            if (streamEnded && stream.total_in > 0) inflateReset(&stream);
+            streamEnded = false;
+
+            std::vector<unsigned char>& output = ring.acquire();
+            stream.next_out = output.data();
+            stream.avail_out = uInt(output.size());
+            int status = inflate(&stream, Z_NO_FLUSH);
+            ring.publish(output.size() - stream.avail_out);
+
+            if (status == Z_STREAM_END) {
+                streamEnded = true;
+            } else if (status != Z_OK && status != Z_BUF_ERROR) {
+                ok = false;
+                break;
+            }
+            outputFull = !streamEnded && stream.avail_out == 0;
+        }
+    }
+
+    // обрезанный файл: последняя часть не дошла до конца
+    ok = ok && streamEnded;
+    inflateEnd(&stream);
+    return ok;
+}
+#endif
+
+#ifdef WORDCOUNT_HAVE_ZSTD
+static bool decompressZstd(int fd, BufferRing& ring) {
+    ZSTD_DStream* stream = ZSTD_createDStream();
+    if (stream == nullptr) return false;
+    ZSTD_initDStream(stream);
+
+    std::vector<unsigned char> input(kCompressedInputSize);
+    bool ok = true;
+    size_t lastStatus = 0;
+
+    while (ok) {
+        ssize_t n = readFull(fd, input.data(), input.size());
+        if (n < 0) {
+            ok = false;
+            break;
+        }
+        if (n == 0) break;
+
+        // как и в inflateGzip, после заполненного выхода поток вызывается снова
+        ZSTD_inBuffer in = {input.data(), size_t(n), 0};
+        bool outputFull = false;
+        while (in.pos < in.size || outputFull) {
+            std::vector<unsigned char>& output = ring.acquire();
+            ZSTD_outBuffer out = {output.data(), output.size(), 0};
+            lastStatus = ZSTD_decompressStream(stream, &out, &in);
+            ring.publish(out.pos);
+            if (ZSTD_isError(lastStatus)) {
+                ok = false;
+                break;
+            }
+            // нулевой статус — кадр распакован и отдан целиком
+            outputFull = out.pos == out.size && lastStatus != 0;
+        }
+    }
+
+    // вход кончился: забираем всё, что поток ещё держит у себя
+    while (ok && lastStatus != 0) {
+        ZSTD_inBuffer in = {input.data(), 0, 0};
+        std::vector<unsigned char>& output = ring.acquire();
+        ZSTD_outBuffer out = {output.data(), output.size(), 0};
+        lastStatus = ZSTD_decompressStream(stream, &out, &in);
+        ring.publish(out.pos);
+        if (ZSTD_isError(lastStatus)) ok = false;
+        if (out.pos == 0) break;
+    }
+
+    // ненулевой статус в конце — последний кадр обрезан
+    ok = ok && lastStatus == 0;
+    ZSTD_freeDStream(stream);
+    return ok;
+}
+#endif
+
+// Распаковка и подсчёт идут конвейером в двух потоках через кольцо буферов
+static bool countCompressed(int fd, Compression compression, CountState& state) {
+    BufferRing ring(kDecompressBuffers, kDecompressBufferSize);
+
+    std::thread decompressor([fd, compression, &ring] {
+        bool ok = false;
+#ifdef WORDCOUNT_HAVE_ZLIB
+        if (compression == Compression::kGzip) ok = inflateGzip(fd, ring);
+#endif
+#ifdef WORDCOUNT_HAVE_ZSTD
+        if (compression == Compression::kZstd) ok = decompressZstd(fd, ring);
+#endif
+        (void)compression;
+        ring.finish(ok);
+    });
+
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    while (ring.next(data, size)) {
+        countBytes(data, size, state);
+        ring.release();
+    }
+    decompressor.join();
+
+    return ring.ok();
+}
+
+// Для сжатого файла кэш годится только целиком: дописанный хвост сжатого
+// потока нельзя досчитать без распаковки всего файла
+static bool countCompressedFile(int fd, const struct stat& st, Compression compression, CountState& state) {
+    ResultCache::Entry cached;
+    if (resultCache != nullptr && resultCache->find(st, cached) && ResultCache::isUnchanged(cached, st)) {
+        state = cached.state;
+        return true;
+    }
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    if (!countCompressed(fd, compression, state)) return false;
+    if (resultCache != nullptr) resultCache->store(st, state);
+
+    return true;
+}
+
+bool countFile(const std::string& filename, int threads, Counts& result) {
+    if (filename == kStdinName) return countStdin(result);
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    CountState state;
+    struct stat st;
+    bool ok = false;
+
+    bool regular = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+    if (regular) {
+        Compression compression = detectCompression(filename, fd);
+        if (compression != Compression::kNone) {
+            // повреждённый архив — ошибка, а не повод считать сжатые байты
+            ok = countCompressedFile(fd, st, compression, state);
+            close(fd);
+            result = finishCount(state);
+            return ok;
+        }
+
+        if (resultCache != nullptr) {
+            ok = countCached(fd, st, threads, state);
+        } else if (selectedMetrics == 0 && st.st_size > 0) {
+            // нужен только размер: файл можно не читать. Нулевому размеру
+            // не верим — так выглядят и непустые файлы procfs и sysfs
+            state.counts.bytes = uint64_t(st.st_size);
+            ok = true;
+        } else {
+            ok = countMapped(fd, 0, uint64_t(st.st_size), threads, state);
+        }
+    }
+    if (!ok) {
+        state = CountState();
+        // обычный файл мог быть прочитан частично, а канал ещё не читали и
+        // перемотать его нельзя
+        ok = (!regular || lseek(fd, 0, SEEK_SET) >= 0) && countBuffered(fd, state);
+    }
+
+    close(fd);
+    result = finishCount(state);
+
+    return ok;
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <sys/stat.h>
+
+struct Counts {
+    uint64_t lines = 0;
+    uint64_t words = 0;
+    uint64_t bytes = 0;
+    uint64_t chars = 0;
+};
+
+// Состояние подсчёта между блоками, чтобы файл можно было обрабатывать по частям.
+// Состояния соседних участков файла объединяются через mergeStates.
+struct CountState {
+    Counts counts;
+    bool startsInWord = false;
+    bool inWord = false;
+    unsigned char lastByte = '\n';
+};
+
+// Набор метрик, которые нужно посчитать. Байты известны всегда, поэтому
+// флага для них нет. Ядра подсчёта инстанцируются для каждого набора, и
+// ненужные метрики не стоят ничего уже на этапе компиляции.
+enum Metric : unsigned {
+    kLines = 1,
+    kWords = 2,
+    kChars = 4,
+    kAllMetrics = kLines | kWords | kChars
+};
+
+// Имя файла, означающее стандартный ввод
+extern const char* const kStdinName;
+
+using CountKernel = void (*)(const unsigned char*, size_t, CountState&);
+
+// Лучшее ядро для набора метрик не выше уровня limit (scalar, ssse3, avx2,
+// avx512; пустая строка — без ограничения), поддерживаемое процессором.
+// Зависит от текущих разделителей, поэтому вызывается после useDelimiters.
+CountKernel selectKernel(unsigned metrics, const std::string& limit);
+// То же с уровнем из переменной окружения WORDCOUNT_KERNEL
+CountKernel selectKernel(unsigned metrics);
+// Есть ли у процессора всё нужное для ядер уровня level
+bool kernelSupported(const std::string& level);
+
+// Байты set становятся разделителями слов вместо пробельных символов ASCII
+void useDelimiters(const std::string& set);
+void useDefaultDelimiters();
+
+// Задаёт набор метрик и ядро, которыми считают функции ниже
+void useKernel(unsigned metrics, CountKernel kernel);
+
+void countBytes(const unsigned char* data, size_t size, CountState& state);
+void mergeStates(CountState& left, const CountState& right);
+Counts finishCount(const CountState& state);
+
+// Файл kStdinName читается из стандартного ввода
+bool countFile(const std::string& filename, int threads, Counts& result);
+bool countStdin(Counts& result);
+
+// Сколько байт уже прочитано всеми потоками, для вывода прогресса
+uint64_t processedBytes();
+
+// Кэш результатов между запусками. Для каждого файла по (устройство, inode)
+// хранятся размер, время изменения, состояние подсчёта на конце файла и хэш
+// последних байт перед этим концом. Неизменённый файл берётся из кэша
+// целиком, а у файла, который только дописывался, считается лишь новый хвост
+// и присоединяется к сохранённому. Дописанным файл считается, только если
+// байты перед старым концом не изменились: после copytruncate или при inode,
+// доставшемся новому файлу, он считается заново.
+class ResultCache {
+public:
+    struct Entry {
+        uint64_t size = 0;
+        int64_t mtimeSec = 0;
+        int64_t mtimeNsec = 0;
+        uint64_t fingerprint = 0;
+        CountState state;
+    };
+
+    // Записи годятся только для тех же разделителей слов: tag их описывает,
+    // и кэш с другим tag считается пустым
+    ResultCache(std::string path, std::string tag);
+
+    // Отсутствующий или испорченный файл кэша означает пустой кэш
+    void load();
+    // Непустой файл, который load не признал кэшем, не перезаписывается
+    bool save() const;
+
+    bool find(const struct stat& st, Entry& entry);
+    void store(const struct stat& st, const CountState& state, uint64_t fingerprint = 0);
+
+    static bool isUnchanged(const Entry& entry, const struct stat& st);
+
+private:
+    struct Key {
+        uint64_t device = 0;
+        uint64_t inode = 0;
+
+        bool operator==(const Key& other) const {
+            return device == other.device && inode == other.inode;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return std::hash<uint64_t>()(key.inode * 0x9E3779B97F4A7C15ull ^ key.device);
+        }
+    };
+
+    static Key keyOf(const struct stat& st);
+
+    std::string path;
+    std::string header;
+    bool foreign = false;
+    std::mutex mutex;
+    std::unordered_map<Key, Entry, KeyHash> entries;
+};
+
+// Подключает кэш к countFile, nullptr отключает его. С кэшем нужно считать
+// все метрики (kAllMetrics), чтобы запись подходила для любого набора флагов.
+void useResultCache(ResultCache* cache);
@@ -0,0 +1,556 @@
+#include <lib/wordcount.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef WORDCOUNT_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef WORDCOUNT_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+// Разделители для проверки: пустая строка — пробельные символы по умолчанию
+const std::string kDefaultSet;
+const std::string kPunctuationSet = ",;";
+// Восемь разных строк таблицы полубайт — ещё помещается в SIMD-ядра
+const std::string kEightRowSet = "\x11\x22\x33\x44\x55\x66\x77\x88,;";
+// Девять строк — слова считает только скалярное ядро
+const std::string kNineRowSet = "\x11\x22\x33\x44\x55\x66\x77\x88\x99";
+
+void applyDelimiters(const std::string& set) {
+    if (set.empty()) useDefaultDelimiters();
+    else useDelimiters(set);
+}
+
+std::string describe(const unsigned char* data, size_t size) {
+    std::string result;
+    for (size_t i = 0; i < size; ++i) {
+        char buffer[4];
+        snprintf(buffer, sizeof(buffer), "%02x", data[i]);
+        result += buffer;
+    }
+    return result;
+}
+
+CountState countWith(CountKernel kernel, unsigned metrics, const std::string& text) {
+    useKernel(metrics, kernel);
+    CountState state;
+    countBytes(reinterpret_cast<const unsigned char*>(text.data()), text.size(), state);
+    return state;
+}
+
+void expectSameState(const CountState& actual, const CountState& expected, const std::string& context) {
+    EXPECT_EQ(actual.counts.lines, expected.counts.lines) << context;
+    EXPECT_EQ(actual.counts.words, expected.counts.words) << context;
+    EXPECT_EQ(actual.counts.bytes, expected.counts.bytes) << context;
+    EXPECT_EQ(actual.counts.chars, expected.counts.chars) << context;
+    EXPECT_EQ(actual.startsInWord, expected.startsInWord) << context;
+    EXPECT_EQ(actual.inWord, expected.inWord) << context;
+    EXPECT_EQ(actual.lastByte, expected.lastByte) << context;
+}
+
+void expectSameCounts(const Counts& actual, const Counts& expected) {
+    EXPECT_EQ(actual.lines, expected.lines);
+    EXPECT_EQ(actual.words, expected.words);
+    EXPECT_EQ(actual.bytes, expected.bytes);
+    EXPECT_EQ(actual.chars, expected.chars);
+}
+
+// Кусочки, из которых собирается текст: буквы, все виды разделителей,
+// многобайтные символы UTF-8 и одиночные продолжающие байты
+const std::vector<std::string> kPieces = {
+    "a", "b", "word", " ", "\n", "\t", "\r\n", ",", ";",
+    "\xC3\xA9", "\xD0\xB6", "\xE2\x82\xAC", "\xF0\x9F\x98\x80",
+    "\x11", "\x55", "\x88", "\x99", "\x80", "\xBF",
+};
+
+std::string randomText(size_t size, std::mt19937& random) {
+    std::string text;
+    while (text.size() < size) text += kPieces[random() % kPieces.size()];
+    text.resize(size);
+    return text;
+}
+
+// Тексты, у которых длина, граница слова или символа UTF-8 приходятся на
+// байты рядом с 63, 64 и 65, а также на следующую границу блока
+std::vector<std::string> kernelInputs() {
+    std::vector<std::string> inputs;
+    const std::vector<std::string> inserts = {" ", "\n", ",", "\x11", "\x99", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80"};
+    for (size_t size : {1, 62, 63, 64, 65, 66, 127, 128, 129, 191, 192, 193}) {
+        inputs.push_back(std::string(size, 'a'));
+        inputs.push_back(std::string(size, ' '));
+        for (size_t position : {61, 62, 63, 64, 65, 127, 128}) {
+            if (position >= size) continue;
+            for (const std::string& insert : inserts) {
+                std::string text(size, 'a');
+                text.replace(position, insert.size(), insert);
+                text.resize(size);
+                inputs.push_back(text);
+
+                std::string spaces(size, ' ');
+                spaces.replace(position, insert.size(), insert);
+                spaces.resize(size);
+                inputs.push_back(spaces);
+            }
+        }
+    }
+
+    std::mt19937 random(2022);
+    for (size_t size = 0; size <= 300; ++size) inputs.push_back(randomText(size, random));
+    return inputs;
+}
+
+std::filesystem::path temporaryPath(const std::string& name) {
+    return std::filesystem::temp_directory_path() / ("wordcount_test_" + std::to_string(getpid()) + "_" + name);
+}
+
+void writeFile(const std::filesystem::path& path, const std::string& text, bool append = false) {
+    std::ofstream file(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+    file << text;
+}
+
+Counts countUncached(const std::filesystem::path& path) {
+    useResultCache(nullptr);
+    Counts result;
+    EXPECT_TRUE(countFile(path.string(), 1, result));
+    return result;
+}
+
+// Считает countStdin, подставив fd вместо стандартного ввода
+bool countAsStdin(int fd, Counts& result) {
+    int saved = dup(STDIN_FILENO);
+    dup2(fd, STDIN_FILENO);
+    bool ok = countStdin(result);
+    dup2(saved, STDIN_FILENO);
+    close(saved);
+    return ok;
+}
+
+// Размер буфера чтения в lib/wordcount.cpp: текст длиннее нескольких буферов,
+// и на их границах разрезаны слово и многобайтный символ
+const size_t kReadBufferSize = 4 << 20;
+
+std::string stdinText() {
+    std::mt19937 random(11);
+    std::string text = randomText(2 * kReadBufferSize + 1000, random);
+    text.replace(kReadBufferSize - 3, 6, "abcdef");
+    text.replace(2 * kReadBufferSize - 2, 4, "\xF0\x9F\x98\x80");
+    return text;
+}
+
+Counts countOnce(const std::string& text) {
+    CountState state;
+    countBytes(reinterpret_cast<const unsigned char*>(text.data()), text.size(), state);
+    return finishCount(state);
+}
+
+// Каждая часть становится отдельным членом gzip; false — нет zlib
+bool writeGzip(const std::filesystem::path& path, const std::vector<std::string>& parts) {
+#ifdef WORDCOUNT_HAVE_ZLIB
+    std::filesystem::remove(path);
+    for (const std::string& part : parts) {
+        gzFile file = gzopen(path.c_str(), "ab");
+        if (file == nullptr) return false;
+        gzwrite(file, part.data(), unsigned(part.size()));
+        gzclose(file);
+    }
+    return true;
+#else
+    (void)path;
+    (void)parts;
+    return false;
+#endif
+}
+
+// Каждая часть становится отдельным кадром zstd; false — нет libzstd
+bool writeZstd(const std::filesystem::path& path, const std::vector<std::string>& parts) {
+#ifdef WORDCOUNT_HAVE_ZSTD
+    std::string archive;
+    for (const std::string& part : parts) {
+        std::string frame(ZSTD_compressBound(part.size()), '\0');
+        size_t size = ZSTD_compress(frame.data(), frame.size(), part.data(), part.size(), 3);
+        if (ZSTD_isError(size)) return false;
+        archive.append(frame.data(), size);
+    }
+    writeFile(path, archive);
+    return true;
+#else
+    (void)path;
+    (void)parts;
+    return false;
+#endif
+}
+
+} // namespace
+
+class KernelTestsSuite : public testing::TestWithParam<std::tuple<const char*, std::string>> {
+protected:
+    void TearDown() override {
+        useDefaultDelimiters();
+    }
+};
+
+TEST_P(KernelTestsSuite, MatchesScalarTest) {
+    const std::string level = std::get<0>(GetParam());
+    if (!kernelSupported(level)) GTEST_SKIP() << level << " не поддерживается процессором";
+
+    applyDelimiters(std::get<1>(GetParam()));
+    std::vector<std::string> inputs = kernelInputs();
+    for (unsigned metrics = 0; metrics <= kAllMetrics; ++metrics) {
+        CountKernel kernel = selectKernel(metrics, level);
+        CountKernel scalar = selectKernel(metrics, "scalar");
+        for (const std::string& text : inputs) {
+            std::string context = level + " metrics=" + std::to_string(metrics) + " text="
+                + describe(reinterpret_cast<const unsigned char*>(text.data()), text.size());
+            expectSameState(countWith(kernel, metrics, text), countWith(scalar, metrics, text), context);
+            if (HasFailure()) return;
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Group,
+    KernelTestsSuite,
+    testing::Combine(
+        testing::Values("scalar", "ssse3", "avx2", "avx512"),
+        testing::Values(kDefaultSet, kPunctuationSet, kEightRowSet, kNineRowSet)
+    )
+);
+
+TEST(KernelTests, ComplexSetFallsBackToScalarTest) {
+    useDelimiters(kNineRowSet);
+    for (unsigned metrics = 0; metrics <= kAllMetrics; ++metrics) {
+        if ((metrics & kWords) != 0) {
+            ASSERT_EQ(selectKernel(metrics, ""), selectKernel(metrics, "scalar"));
+        }
+    }
+    useDefaultDelimiters();
+}
+
+TEST(KernelTests, ScalarCountsTest) {
+    useDefaultDelimiters();
+    Counts counts = finishCount(countWith(selectKernel(kAllMetrics, "scalar"), kAllMetrics, "one two\n\xD0\xB6\xD0\xB6 \xE2\x82\xAC"));
+    ASSERT_EQ(counts.lines, 2);
+    ASSERT_EQ(counts.words, 4);
+    ASSERT_EQ(counts.bytes, 16);
+    ASSERT_EQ(counts.chars, 12);
+}
+
+TEST(MergeTests, SplitRangesMatchSinglePassTest) {
+    useDefaultDelimiters();
+    useKernel(kAllMetrics, selectKernel(kAllMetrics));
+
+    std::mt19937 random(239);
+    for (int round = 0; round < 200; ++round) {
+        std::string text = randomText(1 + random() % 1000, random);
+        const unsigned char* data = reinterpret_cast<const unsigned char*>(text.data());
+
+        CountState whole;
+        countBytes(data, text.size(), whole);
+
+        std::vector<size_t> cuts = {0, text.size()};
+        for (int i = 0; i < 4; ++i) cuts.push_back(random() % (text.size() + 1));
+        std::sort(cuts.begin(), cuts.end());
+
+        CountState merged;
+        for (size_t i = 0; i + 1 < cuts.size(); ++i) {
+            CountState part;
+            countBytes(data + cuts[i], cuts[i + 1] - cuts[i], part);
+            mergeStates(merged, part);
+        }
+
+        expectSameState(merged, whole, describe(data, text.size()));
+        if (HasFailure()) return;
+    }
+}
+
+TEST(MergeTests, ParallelFileMatchesSequentialTest) {
+    useDefaultDelimiters();
+    useKernel(kAllMetrics, selectKernel(kAllMetrics));
+
+    // больше двух участков по kMinParallelChunk, чтобы файл действительно делился
+    std::mt19937 random(2023);
+    std::filesystem::path path = temporaryPath("parallel.txt");
+    writeFile(path, randomText((24 << 20) + 12345, random));
+
+    Counts sequential = countUncached(path);
+    for (int threads : {2, 3, 4}) {
+        Counts parallel;
+        ASSERT_TRUE(countFile(path.string(), threads, parallel));
+        expectSameCounts(parallel, sequential);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(BytesOnlyTests, RegularFileSizeTest) {
+    useKernel(0, selectKernel(0));
+    std::mt19937 random(7);
+    std::filesystem::path path = temporaryPath("bytes.txt");
+    writeFile(path, randomText(123457, random));
+
+    Counts counts;
+    ASSERT_TRUE(countFile(path.string(), 1, counts));
+    ASSERT_EQ(counts.bytes, 123457);
+    std::filesystem::remove(path);
+}
+
+// Канал сообщает нулевой размер, хотя данные в нём есть: их нужно прочитать
+TEST(BytesOnlyTests, ZeroReportedSizeIsReadTest) {
+    useKernel(0, selectKernel(0));
+    std::mt19937 random(8);
+    std::string text = randomText((5 << 20) + 321, random);
+    std::filesystem::path path = temporaryPath("bytes.fifo");
+    ASSERT_EQ(mkfifo(path.c_str(), 0600), 0);
+
+    std::thread writer([&path, &text] { writeFile(path, text); });
+    Counts counts;
+    bool ok = countFile(path.string(), 1, counts);
+    writer.join();
+    std::filesystem::remove(path);
+
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(counts.bytes, text.size());
+}
+
+// То же для обычного файла procfs, если он есть в системе
+TEST(BytesOnlyTests, ProcfsFileIsReadTest) {
+    const std::string path = "/proc/version";
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode) || st.st_size != 0) {
+        GTEST_SKIP() << path << " не сообщает нулевой размер";
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream text;
+    text << file.rdbuf();
+    ASSERT_FALSE(text.str().empty());
+
+    useKernel(0, selectKernel(0));
+    Counts counts;
+    ASSERT_TRUE(countFile(path, 1, counts));
+    ASSERT_EQ(counts.bytes, text.str().size());
+}
+
+TEST(StdinTests, RedirectedFileMatchesSinglePassTest) {
+    useDefaultDelimiters();
+    useKernel(kAllMetrics, selectKernel(kAllMetrics));
+    std::string text = stdinText();
+    std::filesystem::path path = temporaryPath("stdin.txt");
+    writeFile(path, text);
+
+    int fd = open(path.c_str(), O_RDONLY);
+    ASSERT_GE(fd, 0);
+    Counts counts;
+    bool ok = countAsStdin(fd, counts);
+    close(fd);
+    std::filesystem::remove(path);
+
+    ASSERT_TRUE(ok);
+    expectSameCounts(counts, countOnce(text));
+}
+
+TEST(StdinTests, PipeMatchesSinglePassTest) {
+    useDefaultDelimiters();
+    useKernel(kAllMetrics, selectKernel(kAllMetrics));
+    std::string text = stdinText();
+    int pipeFds[2];
+    ASSERT_EQ(pipe(pipeFds), 0);
+
+    // писатель отдаёт данные кусками, которые режут слова и символы UTF-8
+    std::thread writer([&text, fd = pipeFds[1]] {
+        for (size_t done = 0; done < text.size();) {
+            size_t size = std::min<size_t>(text.size() - done, 65537);
+            ssize_t n = write(fd, text.data() + done, size);
+            if (n <= 0) break;
+            done += size_t(n);
+        }
+        close(fd);
+    });
+    Counts counts;
+    bool ok = countAsStdin(pipeFds[0], counts);
+    writer.join();
+    close(pipeFds[0]);
+
+    ASSERT_TRUE(ok);
+    expectSameCounts(counts, countOnce(text));
+}
+
+class CacheTests : public testing::Test {
+protected:
+    void SetUp() override {
+        useDefaultDelimiters();
+        useKernel(kAllMetrics, selectKernel(kAllMetrics));
+        std::filesystem::remove(cachePath);
+    }
+
+    void TearDown() override {
+        useResultCache(nullptr);
+        std::filesystem::remove(cachePath);
+        std::filesystem::remove(textPath);
+    }
+
+    Counts countCached(ResultCache& cache) {
+        useResultCache(&cache);
+        Counts result;
+        EXPECT_TRUE(countFile(textPath.string(), 1, result));
+        useResultCache(nullptr);
+        return result;
+    }
+
+    std::filesystem::path cachePath = temporaryPath("cache");
+    std::filesystem::path textPath = temporaryPath("log.txt");
+    std::mt19937 random{42};
+};
+
+TEST_F(CacheTests, AppendedTailMatchesFreshCountTest) {
+    ResultCache cache(cachePath.string(), "test");
+    writeFile(textPath, randomText(100000, random));
+    countCached(cache);
+
+    // дописанный хвост начинается посреди слова и посреди символа UTF-8
+    writeFile(textPath, "ab\xE2\x82", true);
+    expectSameCounts(countCached(cache), countUncached(textPath));
+    writeFile(textPath, "\xAC" "cd " + randomText(5000, random), true);
+    expectSameCounts(countCached(cache), countUncached(textPath));
+}
+
+TEST_F(CacheTests, ReloadedCacheMatchesFreshCountTest) {
+    writeFile(textPath, randomText(50000, random));
+    {
+        ResultCache cache(cachePath.string(), "test");
+        countCached(cache);
+        ASSERT_TRUE(cache.save());
+    }
+
+    writeFile(textPath, randomText(3000, random), true);
+    ResultCache cache(cachePath.string(), "test");
+    cache.load();
+    struct stat st;
+    ASSERT_EQ(stat(textPath.c_str(), &st), 0);
+    ResultCache::Entry entry;
+    ASSERT_TRUE(cache.find(st, entry));
+    ASSERT_EQ(entry.size, 50000);
+    expectSameCounts(countCached(cache), countUncached(textPath));
+}
+
+TEST_F(CacheTests, RewrittenFileIsRecountedTest) {
+    ResultCache cache(cachePath.string(), "test");
+    writeFile(textPath, std::string(20000, 'a'));
+    countCached(cache);
+
+    // copytruncate и новая запись длиннее прежней: тот же inode, размер вырос
+    writeFile(textPath, randomText(30000, random));
+    expectSameCounts(countCached(cache), countUncached(textPath));
+}
+
+TEST_F(CacheTests, ForeignFileIsNotOverwrittenTest) {
+    writeFile(cachePath, "not a cache\n");
+    ResultCache cache(cachePath.string(), "test");
+    cache.load();
+    ASSERT_FALSE(cache.save());
+
+    std::ifstream file(cachePath);
+    std::string line;
+    std::getline(file, line);
+    ASSERT_EQ(line, "not a cache");
+}
+
+class CompressedTests : public testing::Test {
+protected:
+    void SetUp() override {
+        useDefaultDelimiters();
+        useKernel(kAllMetrics, selectKernel(kAllMetrics));
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(rawPath);
+        std::filesystem::remove(gzipPath);
+        std::filesystem::remove(zstdPath);
+    }
+
+    void expectSameAsRaw(const std::filesystem::path& archive, const std::vector<std::string>& parts) {
+        std::string text;
+        for (const std::string& part : parts) text += part;
+        writeFile(rawPath, text);
+
+        Counts counts;
+        ASSERT_TRUE(countFile(archive.string(), 1, counts));
+        expectSameCounts(counts, countUncached(rawPath));
+    }
+
+    void expectTruncatedFails(const std::filesystem::path& archive) {
+        std::filesystem::resize_file(archive, std::filesystem::file_size(archive) / 2);
+        Counts counts;
+        ASSERT_FALSE(countFile(archive.string(), 1, counts));
+    }
+
+    // Несжимаемое начало сдвигает блоки следующей части относительно буферов
+    // распаковки в 1 МиБ, а сама она сжимается во много раз сильнее, чем 1 МиБ
+    // к блоку чтения: последний блок распаковывается, когда вход уже прочитан
+    std::vector<std::string> compressibleParts() {
+        std::string text;
+        while (text.size() < (8 << 20)) text += "hello world \xD0\xB6\xD0\xB6\n";
+        text.resize(8 << 20);
+        return {randomText(100000, random), text};
+    }
+
+    std::filesystem::path rawPath = temporaryPath("raw.txt");
+    std::filesystem::path gzipPath = temporaryPath("archive.txt.gz");
+    std::filesystem::path zstdPath = temporaryPath("archive.txt.zst");
+    std::mt19937 random{99};
+};
+
+TEST_F(CompressedTests, GzipMultiMemberMatchesRawTest) {
+    std::vector<std::string> parts = {randomText(300000, random), randomText(70001, random), "tail"};
+    if (!writeGzip(gzipPath, parts)) GTEST_SKIP() << "zlib не найдена";
+    expectSameAsRaw(gzipPath, parts);
+}
+
+TEST_F(CompressedTests, GzipCompressibleMatchesRawTest) {
+    std::vector<std::string> parts = compressibleParts();
+    if (!writeGzip(gzipPath, parts)) GTEST_SKIP() << "zlib не найдена";
+    expectSameAsRaw(gzipPath, parts);
+}
+
+TEST_F(CompressedTests, GzipTruncatedFailsTest) {
+    if (!writeGzip(gzipPath, {randomText(300000, random)})) GTEST_SKIP() << "zlib не найдена";
+    expectTruncatedFails(gzipPath);
+}
+
+TEST_F(CompressedTests, ZstdSingleFrameMatchesRawTest) {
+    std::vector<std::string> parts = {randomText(300000, random)};
+    if (!writeZstd(zstdPath, parts)) GTEST_SKIP() << "libzstd не найдена";
+    expectSameAsRaw(zstdPath, parts);
+}
+
+TEST_F(CompressedTests, ZstdMultiFrameMatchesRawTest) {
+    std::vector<std::string> parts = {randomText(300000, random), randomText(70001, random), "tail"};
+    if (!writeZstd(zstdPath, parts)) GTEST_SKIP() << "libzstd не найдена";
+    expectSameAsRaw(zstdPath, parts);
+}
+
+TEST_F(CompressedTests, ZstdCompressibleMatchesRawTest) {
+    std::vector<std::string> parts = compressibleParts();
+    if (!writeZstd(zstdPath, parts)) GTEST_SKIP() << "libzstd не найдена";
+    expectSameAsRaw(zstdPath, parts);
+}
+
+TEST_F(CompressedTests, ZstdTruncatedFailsTest) {
+    if (!writeZstd(zstdPath, {randomText(300000, random)})) GTEST_SKIP() << "libzstd не найдена";
+    expectTruncatedFails(zstdPath);
+}
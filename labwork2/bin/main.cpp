@@ -2,11 +2,12 @@
 #include <iostream>
 
 int main() {
-    // Создаем максимально возможное значение, где все слова = 0xFFFFFFFF
+    // Создаем максимально возможное значение, где все слова = 0xFFFFFFFFFFFFFFFF
     uint2022_t max_value;
     for (int i = 0; i < uint2022_t::SIZE; ++i) {
-        max_value.data[i] = 0xFFFFFFFF;
+        max_value.data[i] = 0xFFFFFFFFFFFFFFFF;
     }
+    max_value.normalize();
 
     // Создаем единицу
     uint2022_t one = from_uint(1);
@@ -1,140 +1,1556 @@
 #include "number.h"
+#include <cstdlib>
 #include <cstring>
 #include <algorithm>
+#include <vector>
 
-uint2022_t from_uint(uint32_t i) {
-    uint2022_t r;
-    r.data[0] = i;
+namespace limb {
 
-    return r;
+// Короче этих порогов множители перемножаются столбиком. Подобраны замером
+// на uint_t<4096> и uint_t<16384>: ниже них лишние сложения Карацубы
+// съедают выигрыш от сэкономленных умножений.
+static const int kKaratsubaThreshold = 24;
+static const int kKaratsubaSquareThreshold = 32;
+// От kNttThreshold слов у меньшего множителя произведение идёт через
+// теоретико-числовое преобразование. Его длина округляется до степени
+// двойки, так что сразу за ней NTT лишь догоняет Карацубу, а с 3000 слов
+// уже вдвое быстрее.
+static const int kNttThreshold = 1500;
+
+// Рабочая память для рекурсии: небольшие запросы — на стеке
+class Scratch {
+public:
+    explicit Scratch(size_t n) {
+        if (n > kLocal) heap_.resize(n);
+        ptr_ = n > kLocal ? heap_.data() : local_;
+    }
+
+    uint64_t* get() {
+        return ptr_;
+    }
+
+private:
+    static const size_t kLocal = 1024;
+    uint64_t local_[kLocal];
+    std::vector<uint64_t> heap_;
+    uint64_t* ptr_;
+};
+
+// Рабочей памяти на n слов множителя хватает с запасом
+static size_t scratch_size(int n) {
+    return 8 * size_t(n) + 64;
+}
+
+// r[0..rn) += a[0..an), an <= rn; возвращает перенос из старшего слова
+static uint64_t add_to(uint64_t* r, int rn, const uint64_t* a, int an) {
+    unsigned char carry = 0;
+    int i = 0;
+    for (; i < an; ++i)
+        r[i] = add_carry(r[i], a[i], carry);
+    for (; carry && i < rn; ++i)
+        r[i] = add_carry(r[i], 0, carry);
+
+    return carry;
+}
+
+// r[0..rn) -= a[0..an), an <= rn; возвращает заём
+static uint64_t sub_from(uint64_t* r, int rn, const uint64_t* a, int an) {
+    unsigned char borrow = 0;
+    int i = 0;
+    for (; i < an; ++i)
+        r[i] = sub_borrow(r[i], a[i], borrow);
+    for (; borrow && i < rn; ++i)
+        r[i] = sub_borrow(r[i], 0, borrow);
+
+    return borrow;
+}
+
+// r = |a - b| на an словах, bn <= an; true, если a < b
+static bool abs_diff(uint64_t* r, const uint64_t* a, int an, const uint64_t* b, int bn) {
+    if (compare(a, significant(a, an), b, significant(b, bn)) < 0) {
+        std::copy(b, b + bn, r);
+        std::fill(r + bn, r + an, 0);
+        sub_from(r, an, a, an);
+        return true;
+    }
+
+    std::copy(a, a + an, r);
+    sub_from(r, an, b, bn);
+    return false;
 }
 
-uint2022_t from_string(const char* buff) {
-    uint2022_t r;
-    for (int pos = 0; buff[pos]; ++pos) {
+// Квадрат столбиком: каждое произведение a[i] * a[j], i < j, считается один
+// раз и удваивается сдвигом, затем добавляются квадраты слов. rn <= 2n.
+static void sqr_basecase(uint64_t* r, int rn, const uint64_t* a, int n) {
+    std::fill(r, r + rn, 0);
+
+    for (int i = 0; i < n; ++i) {
         uint64_t carry = 0;
+        int j = i + 1;
+
+        for (; j < n && i + j < rn; ++j)
+            r[i + j] = mul_add(a[i], a[j], r[i + j], carry);
+        if (i + j < rn) r[i + j] = carry;
+    }
+
+    uint64_t top = 0;
+    for (int i = 0; i < rn; ++i) {
+        uint64_t w = r[i];
+        r[i] = (w << 1) | top;
+        top = w >> 63;
+    }
+
+    unsigned char carry = 0;
+    for (int i = 0; 2 * i < rn; ++i) {
+        uint64_t high;
+        uint64_t low = mul_wide(a[i], a[i], high);
+        r[2 * i] = add_carry(r[2 * i], low, carry);
+        if (2 * i + 1 < rn) r[2 * i + 1] = add_carry(r[2 * i + 1], high, carry);
+    }
+}
+
+// Карацуба: r[0..2n) = a * b, оба множителя по n слов. Средний член
+// считается через разность: a0*b1 + a1*b0 = a0*b0 + a1*b1 - (a0 - a1)(b0 - b1),
+// так что все промежуточные значения неотрицательны и помещаются в n слов.
+static void mul_karatsuba(uint64_t* r, const uint64_t* a, const uint64_t* b, int n, uint64_t* work) {
+    if (n < kKaratsubaThreshold) {
+        mul_basecase(r, 2 * n, a, n, b, n);
+        return;
+    }
+
+    int h = n / 2;
+    int l = n - h;
+    uint64_t* da = work;
+    uint64_t* db = da + l;
+    uint64_t* t = db + l;
+    uint64_t* next = t + 2 * l;
+
+    bool negative = abs_diff(da, a, l, a + l, h) != abs_diff(db, b, l, b + l, h);
+    mul_karatsuba(r, a, b, l, next);
+    mul_karatsuba(r + 2 * l, a + l, b + l, h, next);
+    mul_karatsuba(t, da, db, l, next);
+
+    uint64_t* mid = next;
+    std::copy(r, r + 2 * l, mid);
+    mid[2 * l] = add_to(mid, 2 * l, r + 2 * l, 2 * h);
+    if (negative)
+        add_to(mid, 2 * l + 1, t, 2 * l);
+    else
+        sub_from(mid, 2 * l + 1, t, 2 * l);
+
+    add_to(r + l, 2 * n - l, mid, 2 * l + 1);
+}
+
+// То же для квадрата: средний член a0² + a1² - (a0 - a1)²
+static void sqr_karatsuba(uint64_t* r, const uint64_t* a, int n, uint64_t* work) {
+    if (n < kKaratsubaSquareThreshold) {
+        sqr_basecase(r, 2 * n, a, n);
+        return;
+    }
+
+    int h = n / 2;
+    int l = n - h;
+    uint64_t* da = work;
+    uint64_t* t = da + l;
+    uint64_t* next = t + 2 * l;
 
-        for (int i = 0; i < uint2022_t::SIZE; ++i) {
-            uint64_t t = (uint64_t)r.data[i] * 10 + carry;
-            r.data[i] = uint32_t(t);
-            carry = t >> 32;
+    abs_diff(da, a, l, a + l, h);
+    sqr_karatsuba(r, a, l, next);
+    sqr_karatsuba(r + 2 * l, a + l, h, next);
+    sqr_karatsuba(t, da, l, next);
+
+    uint64_t* mid = next;
+    std::copy(r, r + 2 * l, mid);
+    mid[2 * l] = add_to(mid, 2 * l, r + 2 * l, 2 * h);
+    sub_from(mid, 2 * l + 1, t, 2 * l);
+
+    add_to(r + l, 2 * n - l, mid, 2 * l + 1);
+}
+
+// Теоретико-числовое преобразование по простому P = c·2^m + 1 < 2^62 с
+// первообразным корнем 3. Цифры свёртки — целые 64-битные слова.
+template <uint64_t P>
+static uint64_t pow_mod(uint64_t base, uint64_t exp) {
+    uint64_t r = 1;
+    for (; exp; exp >>= 1) {
+        if (exp & 1) r = uint64_t((unsigned __int128)r * base % P);
+        base = uint64_t((unsigned __int128)base * base % P);
+    }
+
+    return r;
+}
+
+// floor(w·2^64 / P) для умножения на w по Шупу
+template <uint64_t P>
+static uint64_t shoup(uint64_t w) {
+    return uint64_t(((unsigned __int128)w << 64) / P);
+}
+
+// a·w mod P при известном w' = floor(w·2^64 / P): частное оценивается одним
+// умножением и ошибается не больше чем на единицу
+template <uint64_t P>
+static inline uint64_t mul_shoup(uint64_t a, uint64_t w, uint64_t w_shoup) {
+    uint64_t q = uint64_t(((unsigned __int128)a * w_shoup) >> 64);
+    uint64_t r = a * w - q * P;
+    return r >= P ? r - P : r;
+}
+
+// a·b·2^-64 mod P — редукция Монтгомери для поточечных произведений, где
+// ни один множитель не известен заранее
+template <uint64_t P>
+static inline uint64_t mul_redc(uint64_t a, uint64_t b) {
+    constexpr uint64_t neg_inv = [] {
+        uint64_t inv = P;
+        for (int i = 0; i < 5; ++i) inv *= 2 - P * inv;
+        return 0 - inv;
+    }();
+
+    unsigned __int128 t = (unsigned __int128)a * b;
+    uint64_t m = uint64_t(t) * neg_inv;
+    uint64_t r = uint64_t((t + (unsigned __int128)m * P) >> 64);
+    return r >= P ? r - P : r;
+}
+
+// Степени корня для всех уровней преобразования: на уровне с полушагом
+// half корни w_{2·half}^j лежат в roots[half + j] вместе с множителями
+// Шупа. Таблица на n годится и для всех меньших длин, поэтому она
+// строится один раз на поток и только растёт.
+template <uint64_t P>
+struct NttRoots {
+    std::vector<uint64_t> roots;
+    std::vector<uint64_t> shoup;
+
+    static const NttRoots& get(size_t n, bool invert) {
+        thread_local NttRoots tables[2];
+        NttRoots& t = tables[invert];
+        if (t.roots.size() < n) t.build(n, invert);
+        return t;
+    }
+
+private:
+    void build(size_t n, bool invert) {
+        roots.resize(n);
+        shoup.resize(n);
+        for (size_t half = 1; half < n; half <<= 1) {
+            uint64_t w = pow_mod<P>(3, (P - 1) / (2 * half));
+            if (invert) w = pow_mod<P>(w, P - 2);
+            uint64_t ws = limb::shoup<P>(w);
+
+            uint64_t x = 1;
+            for (size_t j = 0; j < half; ++j) {
+                roots[half + j] = x;
+                shoup[half + j] = limb::shoup<P>(x);
+                x = mul_shoup<P>(x, w, ws);
+            }
         }
+    }
+};
 
-        uint32_t d = buff[pos] - '0';
-        carry = d;
+// Прямое преобразование с прореживанием по частоте: результат выходит в
+// бит-обратном порядке, который обратному преобразованию и нужен
+template <uint64_t P>
+static void ntt_forward(uint64_t* a, size_t n, const NttRoots<P>& table) {
+    for (size_t half = n >> 1; half; half >>= 1) {
+        const uint64_t* w = table.roots.data() + half;
+        const uint64_t* ws = table.shoup.data() + half;
+        for (size_t i = 0; i < n; i += 2 * half) {
+            for (size_t j = 0; j < half; ++j) {
+                uint64_t u = a[i + j];
+                uint64_t v = a[i + j + half];
+                a[i + j] = u + v >= P ? u + v - P : u + v;
+                a[i + j + half] = mul_shoup<P>(u >= v ? u - v : u + P - v, w[j], ws[j]);
+            }
+        }
+    }
+}
 
-        for (int i = 0; i < uint2022_t::SIZE && carry; ++i) {
-            uint64_t t = (uint64_t)r.data[i] + carry;
-            r.data[i] = uint32_t(t);
-            carry = t >> 32;
+// Обратное преобразование с прореживанием по времени из бит-обратного
+// порядка в естественный, без деления на n
+template <uint64_t P>
+static void ntt_inverse(uint64_t* a, size_t n, const NttRoots<P>& table) {
+    for (size_t half = 1; half < n; half <<= 1) {
+        const uint64_t* w = table.roots.data() + half;
+        const uint64_t* ws = table.shoup.data() + half;
+        for (size_t i = 0; i < n; i += 2 * half) {
+            for (size_t j = 0; j < half; ++j) {
+                uint64_t u = a[i + j];
+                uint64_t v = mul_shoup<P>(a[i + j + half], w[j], ws[j]);
+                a[i + j] = u + v >= P ? u + v - P : u + v;
+                a[i + j + half] = u >= v ? u - v : u + P - v;
+            }
         }
     }
+}
 
-    return r;
+// Свёртка слов a и b по модулю P длины n
+template <uint64_t P>
+static std::vector<uint64_t> convolve(const uint64_t* a, int an, const uint64_t* b, int bn, size_t n) {
+    auto digits = [n](const uint64_t* x, int xn) {
+        std::vector<uint64_t> d(n);
+        for (int i = 0; i < xn; ++i)
+            d[i] = x[i] % P;
+        return d;
+    };
+
+    const NttRoots<P>& forward = NttRoots<P>::get(n, false);
+    std::vector<uint64_t> fa = digits(a, an);
+    ntt_forward(fa.data(), n, forward);
+    if (a == b && an == bn) {
+        for (size_t i = 0; i < n; ++i)
+            fa[i] = mul_redc<P>(fa[i], fa[i]);
+    } else {
+        std::vector<uint64_t> fb = digits(b, bn);
+        ntt_forward(fb.data(), n, forward);
+        for (size_t i = 0; i < n; ++i)
+            fa[i] = mul_redc<P>(fa[i], fb[i]);
+    }
+
+    // множитель 2^-64 от редукции и деление на n снимаются одним умножением
+    ntt_inverse(fa.data(), n, NttRoots<P>::get(n, true));
+    uint64_t r = uint64_t(((unsigned __int128)1 << 64) % P);
+    uint64_t scale = uint64_t((unsigned __int128)r * pow_mod<P>(n, P - 2) % P);
+    uint64_t scale_shoup = shoup<P>(scale);
+    for (size_t i = 0; i < n; ++i)
+        fa[i] = mul_shoup<P>(fa[i], scale, scale_shoup);
+
+    return fa;
+}
+
+// Три простых, произведение ~2^186: коэффициент свёртки — сумма меньше
+// 2^57 произведений слов, так что китайская теорема об остатках
+// восстанавливает его однозначно
+static const uint64_t kNttP1 = 4611613450659954689ULL;  // 2097119·2^41 + 1
+static const uint64_t kNttP2 = 4610815205218189313ULL;  // 524189·2^43 + 1
+static const uint64_t kNttP3 = 4611105476287922177ULL;  // 262111·2^44 + 1
+
+// r[0..an+bn) = a * b через свёртки по трём простым и сборку Гарнера
+static void mul_ntt(uint64_t* r, const uint64_t* a, int an, const uint64_t* b, int bn) {
+    size_t n = 1;
+    while (n < size_t(an) + size_t(bn)) n <<= 1;
+
+    std::vector<uint64_t> c1 = convolve<kNttP1>(a, an, b, bn, n);
+    std::vector<uint64_t> c2 = convolve<kNttP2>(a, an, b, bn, n);
+    std::vector<uint64_t> c3 = convolve<kNttP3>(a, an, b, bn, n);
+
+    // x = c1 + P1·k2 + P1·P2·k3
+    const uint64_t inv1 = pow_mod<kNttP2>(kNttP1 % kNttP2, kNttP2 - 2);
+    const uint64_t inv1_shoup = shoup<kNttP2>(inv1);
+    const uint64_t p1 = kNttP1 % kNttP3;
+    const uint64_t p1_shoup = shoup<kNttP3>(p1);
+    const uint64_t inv12 = pow_mod<kNttP3>(uint64_t((unsigned __int128)kNttP1 * kNttP2 % kNttP3), kNttP3 - 2);
+    const uint64_t inv12_shoup = shoup<kNttP3>(inv12);
+    const unsigned __int128 p12 = (unsigned __int128)kNttP1 * kNttP2;
+
+    // перенос — 192-битное окно: младшие 128 бит и старшее слово
+    unsigned __int128 lo = 0;
+    uint64_t hi = 0;
+    for (int i = 0; i < an + bn; ++i) {
+        uint64_t x1 = c1[i];
+        uint64_t x1_2 = x1 >= kNttP2 ? x1 - kNttP2 : x1;
+        uint64_t k2 = mul_shoup<kNttP2>(c2[i] >= x1_2 ? c2[i] - x1_2 : c2[i] + kNttP2 - x1_2, inv1, inv1_shoup);
+
+        uint64_t x12_3 = (x1 >= kNttP3 ? x1 - kNttP3 : x1) + mul_shoup<kNttP3>(k2, p1, p1_shoup);
+        if (x12_3 >= kNttP3) x12_3 -= kNttP3;
+        uint64_t k3 = mul_shoup<kNttP3>(c3[i] >= x12_3 ? c3[i] - x12_3 : c3[i] + kNttP3 - x12_3, inv12, inv12_shoup);
+
+        unsigned __int128 x12 = x1 + (unsigned __int128)kNttP1 * k2;
+        unsigned __int128 low = (unsigned __int128)uint64_t(p12) * k3;
+        unsigned __int128 high = (unsigned __int128)uint64_t(p12 >> 64) * k3;
+
+        lo += x12;
+        hi += lo < x12;
+        lo += low;
+        hi += lo < low;
+        unsigned __int128 shifted = high << 64;
+        lo += shifted;
+        hi += uint64_t(high >> 64) + (lo < shifted);
+
+        r[i] = uint64_t(lo);
+        lo = (lo >> 64) | ((unsigned __int128)hi << 64);
+        hi = 0;
+    }
+}
+
+// Полное произведение r[0..an+bn), an >= bn. Длинные множители идут через
+// NTT, а иначе длинный множитель режется на куски по bn слов, каждый
+// кусок — Карацуба с равными длинами.
+static void mul_full(uint64_t* r, const uint64_t* a, int an, const uint64_t* b, int bn) {
+    if (bn < kKaratsubaThreshold) {
+        mul_basecase(r, an + bn, a, an, b, bn);
+        return;
+    }
+    if (bn >= kNttThreshold) {
+        mul_ntt(r, a, an, b, bn);
+        return;
+    }
+
+    Scratch scratch(2 * size_t(bn) + scratch_size(bn));
+    uint64_t* t = scratch.get();
+    uint64_t* work = t + 2 * bn;
+
+    if (an == bn) {
+        mul_karatsuba(r, a, b, bn, work);
+        return;
+    }
+
+    std::fill(r, r + an + bn, 0);
+    for (int i = 0; i < an; i += bn) {
+        int k = std::min(bn, an - i);
+        if (k == bn)
+            mul_karatsuba(t, a + i, b, bn, work);
+        else
+            mul_full(t, b, bn, a + i, k);
+        add_to(r + i, an + bn - i, t, k + bn);
+    }
+}
+
+// Младшие n слов произведения двух n-словных чисел. Младшие половины
+// перемножаются полностью, а перекрёстным произведениям нужны только их
+// младшие h слов — они снова считаются этой же функцией.
+static void mul_low(uint64_t* r, const uint64_t* a, const uint64_t* b, int n, uint64_t* work) {
+    if (n < kKaratsubaThreshold) {
+        mul_basecase(r, n, a, n, b, n);
+        return;
+    }
+
+    int h = n / 2;
+    int l = n - h;
+    uint64_t* t = work;
+
+    mul_karatsuba(t, a, b, l, t + 2 * l);
+    std::copy(t, t + n, r);
+
+    mul_low(t, a, b + l, h, t + h);
+    add_to(r + l, h, t, h);
+    mul_low(t, a + l, b, h, t + h);
+    add_to(r + l, h, t, h);
+}
+
+// Младшие n слов квадрата n-словного числа
+static void sqr_low(uint64_t* r, const uint64_t* a, int n, uint64_t* work) {
+    if (n < kKaratsubaSquareThreshold) {
+        sqr_basecase(r, n, a, n);
+        return;
+    }
+
+    int h = n / 2;
+    int l = n - h;
+    uint64_t* t = work;
+
+    sqr_karatsuba(t, a, l, t + 2 * l);
+    std::copy(t, t + n, r);
+
+    mul_low(t, a, a + l, h, t + h);
+    add_to(r + l, h, t, h);
+    add_to(r + l, h, t, h);
+}
+
+void mul(uint64_t* r, int rn, const uint64_t* a, int an, const uint64_t* b, int bn) {
+    an = std::min(an, rn);
+    bn = std::min(bn, rn);
+    if (an < bn) {
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+
+    if (bn < kKaratsubaThreshold) {
+        mul_basecase(r, std::min(rn, an + bn), a, an, b, bn);
+    } else if (rn >= an + bn) {
+        mul_full(r, a, an, b, bn);
+    } else if (bn == rn) {
+        Scratch scratch(scratch_size(rn));
+        mul_low(r, a, b, rn, scratch.get());
+    } else {
+        Scratch scratch(an + bn);
+        mul_full(scratch.get(), a, an, b, bn);
+        std::copy(scratch.get(), scratch.get() + rn, r);
+    }
+}
+
+void sqr(uint64_t* r, int rn, const uint64_t* a, int an) {
+    an = std::min(an, rn);
+
+    if (an < kKaratsubaSquareThreshold) {
+        sqr_basecase(r, std::min(rn, 2 * an), a, an);
+    } else if (rn >= 2 * an && an >= kNttThreshold) {
+        mul_ntt(r, a, an, a, an);
+    } else if (rn >= 2 * an) {
+        Scratch scratch(scratch_size(an));
+        sqr_karatsuba(r, a, an, scratch.get());
+    } else if (an == rn) {
+        Scratch scratch(scratch_size(rn));
+        sqr_low(r, a, rn, scratch.get());
+    } else {
+        Scratch scratch(2 * size_t(an) + scratch_size(an));
+        sqr_karatsuba(scratch.get(), a, an, scratch.get() + 2 * an);
+        std::copy(scratch.get(), scratch.get() + rn, r);
+    }
+}
+
+// Длинные числа делятся пополам по степеням
+// 10^(19·2^k), и половины обрабатываются рекурсивно: умножение и деление
+// больших частей тогда идут через Карацубу и алгоритм D, а не словом за раз.
+// Пороги перехода на деление пополам, подобраны замером. Разбор кусками
+// обходится умножениями на слово, поэтому деление пополам окупается у него
+// только на десятках тысяч цифр; печати мешают деления, и порог ниже.
+static const int kPrintSplitLimbs = 32;
+static const size_t kParseSplitDigits = 30000;
+
+// floor((2^128 - 1) / 10^19) - 2^64; 10^19 уже нормализовано (старший бит — единица)
+static const uint64_t kChunkInverse = uint64_t(~(unsigned __int128)0 / kChunkBase);
+
+// (high:low) / 10^19 при high < 10^19 умножением на обратное вместо divq
+// (Möller, Granlund, «Improved division by invariant integers», алгоритм 4)
+static uint64_t div_chunk(uint64_t high, uint64_t low, uint64_t& rem) {
+    unsigned __int128 q = (unsigned __int128)kChunkInverse * high + (((unsigned __int128)high << 64) | low);
+    uint64_t q1 = uint64_t(q >> 64) + 1;
+    uint64_t q0 = uint64_t(q);
+    uint64_t r = low - q1 * kChunkBase;
+
+    if (r > q0) {
+        --q1;
+        r += kChunkBase;
+    }
+    if (r >= kChunkBase) {
+        ++q1;
+        r -= kChunkBase;
+    }
+    rem = r;
+
+    return q1;
+}
+
+// Степени 10^(19·2^k), каждая обрезана до limit слов
+static std::vector<std::vector<uint64_t>> chunk_powers(int limit, size_t count) {
+    std::vector<std::vector<uint64_t>> powers(1, std::vector<uint64_t>(1, kChunkBase));
+
+    while (powers.size() < count) {
+        const std::vector<uint64_t>& last = powers.back();
+        int n = int(last.size());
+        std::vector<uint64_t> next(std::min(2 * n, limit));
+        sqr(next.data(), int(next.size()), last.data(), n);
+        next.resize(significant(next.data(), int(next.size())));
+        powers.push_back(std::move(next));
+    }
+
+    return powers;
+}
+
+// Разбор делением пополам: старшие цифры * 10^(19·2^k) + младшие 19·2^k цифр
+static int parse_split(uint64_t* r, int rn, const char* buff, size_t len,
+                       const std::vector<std::vector<uint64_t>>& powers) {
+    if (len <= kParseSplitDigits) return parse_decimal(r, rn, buff, len);
+
+    size_t k = 0;
+    while (k + 1 < powers.size() && (size_t(kChunkDigits) << (k + 1)) < len) ++k;
+    size_t low_len = size_t(kChunkDigits) << k;
+
+    std::vector<uint64_t> high(rn);
+    int high_used = parse_split(high.data(), rn, buff, len - low_len, powers);
+    int low_used = parse_split(r, rn, buff + len - low_len, low_len, powers);
+
+    std::vector<uint64_t> t(rn);
+    const std::vector<uint64_t>& p = powers[k];
+    mul(t.data(), rn, high.data(), high_used, p.data(), int(p.size()));
+    int t_used = significant(t.data(), std::min(rn, high_used + int(p.size())));
+
+    int n = std::max(t_used, low_used);
+    uint64_t carry = add_to(r, n, t.data(), t_used);
+    if (carry && n < rn) r[n++] = carry;
+
+    return significant(r, n);
+}
+
+int from_decimal(uint64_t* r, int rn, const char* buff) {
+    size_t len = strlen(buff);
+    if (len <= kParseSplitDigits) return parse_decimal(r, rn, buff, len);
+
+    size_t count = 1;
+    while ((size_t(kChunkDigits) << count) < len) ++count;
+    return parse_split(r, rn, buff, len, chunk_powers(rn, count));
+}
+
+// Дописывает число в out; при width > 0 — ровно width цифр с ведущими нулями
+static void print_chunks(std::string& out, std::vector<uint64_t> a, size_t width) {
+    int n = significant(a.data(), int(a.size()));
+    std::vector<uint64_t> chunks;
+
+    while (n != 0) {
+        uint64_t rem = 0;
+        for (int i = n - 1; i >= 0; --i)
+            a[i] = div_chunk(rem, a[i], rem);
+        chunks.push_back(rem);
+        n = significant(a.data(), n);
+    }
+
+    size_t total = chunks.size() * kChunkDigits;
+    std::string s(total, '0');
+    size_t pos = total;
+    for (uint64_t chunk : chunks) {
+        for (int i = 0; i < kChunkDigits; ++i) {
+            s[--pos] = char('0' + chunk % 10);
+            chunk /= 10;
+        }
+    }
+
+    size_t start = std::min(s.find_first_not_of('0'), total);
+    if (width > total - start) out.append(width - (total - start), '0');
+    out.append(s, start, std::string::npos);
 }
 
-uint2022_t operator+(const uint2022_t& a, const uint2022_t& b) {
-    uint2022_t r;
+// Печать делением пополам на подходящую степень 10^(19·2^k)
+static void print_split(std::string& out, std::vector<uint64_t> a, size_t width,
+                        const std::vector<std::vector<uint64_t>>& powers) {
+    int n = significant(a.data(), int(a.size()));
+    if (n <= kPrintSplitLimbs) {
+        print_chunks(out, std::move(a), width);
+        return;
+    }
+
+    size_t k = 0;
+    while (k + 1 < powers.size() && 2 * int(powers[k + 1].size()) <= n + 1) ++k;
+    const std::vector<uint64_t>& p = powers[k];
+    int pn = int(p.size());
+    size_t low_width = size_t(kChunkDigits) << k;
+
+    std::vector<uint64_t> q(n - pn + 1);
+    std::vector<uint64_t> r(pn);
+    if (pn == 1) {
+        r[0] = divmod_1(q.data(), a.data(), n, p[0]);
+    } else {
+        std::vector<uint64_t> work(n + pn + 1);
+        divmod(q.data(), r.data(), a.data(), n, p.data(), pn, work.data());
+    }
+
+    print_split(out, std::move(q), width > low_width ? width - low_width : 0, powers);
+    print_split(out, std::move(r), low_width, powers);
+}
+
+// r += a * m, возвращает старшее слово
+static uint64_t addmul_1(uint64_t* r, const uint64_t* a, int n, uint64_t m) {
     uint64_t carry = 0;
+    for (int i = 0; i < n; ++i)
+        r[i] = mul_add(a[i], m, r[i], carry);
+
+    return carry;
+}
+
+uint64_t mont_inverse(uint64_t m0) {
+    // Ньютон: каждый шаг удваивает число верных младших битов, а m0 * m0 ≡ 1
+    // по модулю 8 даёт первые три
+    uint64_t x = m0;
+    for (int i = 0; i < 5; ++i)
+        x *= 2 - m0 * x;
 
-    for (int i = 0; i < uint2022_t::SIZE; ++i) {
-        uint64_t t = (uint64_t)a.data[i] + b.data[i] + carry;
-        r.data[i] = uint32_t(t);
-        carry = t >> 32;
+    return -x;
+}
+
+void mont_r2(uint64_t* r, const uint64_t* m, int n) {
+    Scratch scratch(2 * size_t(n) + 1 + (n + 2) + (3 * size_t(n) + 2));
+    uint64_t* a = scratch.get();
+    uint64_t* q = a + 2 * n + 1;
+    uint64_t* work = q + n + 2;
+
+    std::fill(a, a + 2 * n, 0);
+    a[2 * n] = 1;
+    if (n == 1)
+        r[0] = divmod_1(q, a, 3, m[0]);
+    else
+        divmod(q, r, a, 2 * n + 1, m, n, work);
+}
+
+// Редукция Монтгомери t[0..2n) -> r[0..n): к t по слову добавляются кратные
+// m, обнуляющие младшие слова, и остаётся t / R < 2m
+static void redc(uint64_t* r, uint64_t* t, const uint64_t* m, int n, uint64_t inv) {
+    unsigned char top = 0;
+    for (int i = 0; i < n; ++i) {
+        uint64_t carry = addmul_1(t + i, m, n, t[i] * inv);
+        t[i + n] = add_carry(t[i + n], carry, top);
     }
 
-    return r;
+    if (top || compare(t + n, n, m, n) >= 0)
+        sub(r, t + n, m, n);
+    else
+        std::copy(t + n, t + 2 * n, r);
 }
 
-uint2022_t operator-(const uint2022_t& a, const uint2022_t& b) {
-    uint2022_t r;
-    int64_t borrow = 0;
+void mont_mul(uint64_t* r, const uint64_t* a, const uint64_t* b, const uint64_t* m, int n, uint64_t inv) {
+    Scratch scratch(2 * size_t(n));
+    mul(scratch.get(), 2 * n, a, n, b, n);
+    redc(r, scratch.get(), m, n, inv);
+}
+
+void mont_sqr(uint64_t* r, const uint64_t* a, const uint64_t* m, int n, uint64_t inv) {
+    Scratch scratch(2 * size_t(n));
+    sqr(scratch.get(), 2 * n, a, n);
+    redc(r, scratch.get(), m, n, inv);
+}
+
+void mont_redc(uint64_t* r, const uint64_t* a, const uint64_t* m, int n, uint64_t inv) {
+    Scratch scratch(2 * size_t(n));
+    std::copy(a, a + n, scratch.get());
+    std::fill(scratch.get() + n, scratch.get() + 2 * n, 0);
+    redc(r, scratch.get(), m, n, inv);
+}
+
+// Биты [s, s + 61) числа a
+static uint64_t bits_at(const uint64_t* a, int n, int s) {
+    int w = s / 64;
+    int b = s % 64;
+    uint64_t r = w < n ? a[w] >> b : 0;
+    if (b && w + 1 < n) r |= a[w + 1] << (64 - b);
+    return r & ((uint64_t(1) << 61) - 1);
+}
+
+// Матрица Лемера (Кнут, т. 2, 4.5.2, алгоритм L): шаги Евклида по старшим
+// 61 биту x и y, пока частные приближений снизу и сверху совпадают — тогда
+// это частные и полных чисел, и steps шагов сводятся к (x, y) ->
+// (ax + by, cx + dy). Коэффициенты по модулю не больше 2^61, знаки a и b
+// (как и c и d) разные.
+struct LehmerMatrix {
+    int64_t a = 1, b = 0, c = 0, d = 1;
+    int steps = 0;
+};
+
+static LehmerMatrix lehmer_matrix(const uint64_t* x, const uint64_t* y, int n) {
+    int s = std::max(n * 64 - __builtin_clzll(x[n - 1]) - 61, 0);
+    int64_t xh = int64_t(bits_at(x, n, s));
+    int64_t yh = int64_t(bits_at(y, n, s));
+
+    LehmerMatrix m;
+    while (yh + m.c > 0 && yh + m.d > 0) {
+        int64_t q = (xh + m.a) / (yh + m.c);
+        if (q != (xh + m.b) / (yh + m.d)) break;
+
+        int64_t t = m.a - q * m.c;
+        m.a = m.c;
+        m.c = t;
+        t = m.b - q * m.d;
+        m.b = m.d;
+        m.d = t;
+        t = xh - q * yh;
+        xh = yh;
+        yh = t;
+        ++m.steps;
+    }
+
+    return m;
+}
+
+// r = a·x + b·y по n словам, когда у a и b разные знаки (или одно из них
+// ноль), а результат неотрицателен; r не совпадает с x и y
+static void combine(uint64_t* r, const uint64_t* x, const uint64_t* y, int n, int64_t a, int64_t b) {
+    if (a < 0 || b > 0) {
+        std::swap(x, y);
+        std::swap(a, b);
+    }
+    mul_1(r, x, n, uint64_t(a), 0);
+    submul_1(r, y, n, uint64_t(-b));
+}
+
+// Алгоритм Евклида над x >= y шагами Лемера, а где их не вышло — делением
+// с остатком. При track ведутся модули коэффициентов при исходном y:
+// x ≡ ±u0·y и y ≡ ∓u1·y по модулю исходного x. Знаки коэффициентов
+// чередуются с каждым шагом Евклида, так что модули только складываются,
+// а знак u0 — (-1)^(steps + 1).
+class Euclid {
+public:
+    Euclid(const uint64_t* x, int xn, const uint64_t* y, int yn, bool track)
+        : x_(x, x + xn), y_(xn), tx_(xn), ty_(xn), n_(xn), track_(track) {
+        std::copy(y, y + yn, y_.begin());
+        yn_ = significant(y_.data(), n_);
+        if (track) {
+            u0_.assign(xn + 1, 0);
+            u1_.assign(xn + 1, 0);
+            u1_[0] = 1;
+            t0_.resize(xn + 1);
+            t1_.resize(xn + 1);
+        }
+    }
+
+    // Значимы только младшие x_size() слов x и y_size() слов y
+    const uint64_t* x() const {
+        return x_.data();
+    }
+
+    const uint64_t* y() const {
+        return y_.data();
+    }
+
+    int x_size() const {
+        return n_;
+    }
+
+    int y_size() const {
+        return yn_;
+    }
+
+    const uint64_t* u0() const {
+        return u0_.data();
+    }
+
+    int steps() const {
+        return steps_;
+    }
+
+    void step() {
+        LehmerMatrix m = lehmer_matrix(x_.data(), y_.data(), n_);
+        if (m.steps == 0)
+            divide();
+        else
+            apply(m);
+
+        n_ = significant(x_.data(), n_);
+        yn_ = significant(y_.data(), n_);
+    }
 
-    for (int i = 0; i < uint2022_t::SIZE; ++i) {
-        int64_t t = (int64_t)a.data[i] - b.data[i] - borrow;
+private:
+    void apply(const LehmerMatrix& m) {
+        combine(tx_.data(), x_.data(), y_.data(), n_, m.a, m.b);
+        combine(ty_.data(), x_.data(), y_.data(), n_, m.c, m.d);
+        std::swap(x_, tx_);
+        std::swap(y_, ty_);
 
-        if (t < 0) {
-            t += (1LL << 32);
-            borrow = 1;
+        if (track_) {
+            int un = int(u0_.size());
+            mul_1(t0_.data(), u0_.data(), un, uint64_t(std::abs(m.a)), 0);
+            addmul_1(t0_.data(), u1_.data(), un, uint64_t(std::abs(m.b)));
+            mul_1(t1_.data(), u0_.data(), un, uint64_t(std::abs(m.c)), 0);
+            addmul_1(t1_.data(), u1_.data(), un, uint64_t(std::abs(m.d)));
+            std::swap(u0_, t0_);
+            std::swap(u1_, t1_);
+        }
+        steps_ += m.steps;
+    }
+
+    // (x, y) -> (y, x mod y), (u0, u1) -> (u1, u0 + q·u1)
+    void divide() {
+        int qn = n_ - yn_ + 1;
+        std::vector<uint64_t> q(qn);
+        if (yn_ == 1) {
+            tx_[0] = divmod_1(q.data(), x_.data(), n_, y_[0]);
         } else {
-            borrow = 0;
+            std::vector<uint64_t> work(n_ + yn_ + 1);
+            divmod(q.data(), tx_.data(), x_.data(), n_, y_.data(), yn_, work.data());
         }
-        r.data[i] = uint32_t(t);
+        std::fill(tx_.begin() + yn_, tx_.begin() + n_, 0);
+        std::swap(x_, y_);
+        std::swap(y_, tx_);
+
+        if (track_) {
+            int un = int(u0_.size());
+            std::fill(t0_.begin(), t0_.end(), 0);
+            mul(t0_.data(), un, q.data(), significant(q.data(), qn), u1_.data(), significant(u1_.data(), un));
+            add_to(t0_.data(), un, u0_.data(), un);
+            std::swap(u0_, u1_);
+            std::swap(u1_, t0_);
+        }
+        ++steps_;
+    }
+
+    std::vector<uint64_t> x_, y_, tx_, ty_;
+    std::vector<uint64_t> u0_, u1_, t0_, t1_;
+    int n_;
+    int yn_;
+    int steps_ = 0;
+    bool track_;
+};
+
+// Бинарный алгоритм Стейна: вместо деления — сдвиги и вычитания
+static uint64_t gcd_1(uint64_t a, uint64_t b) {
+    if (a == 0 || b == 0) return a | b;
+
+    int shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    while (b) {
+        b >>= __builtin_ctzll(b);
+        if (a > b) std::swap(a, b);
+        b -= a;
+    }
+
+    return a << shift;
+}
+
+int gcd(uint64_t* r, const uint64_t* a, int an, const uint64_t* b, int bn) {
+    an = significant(a, an);
+    bn = significant(b, bn);
+    if (compare(a, an, b, bn) < 0) {
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+    if (bn == 0) {
+        std::copy(a, a + an, r);
+        return an;
+    }
+
+    // длинные числа — шагами Лемера, последнее слово — бинарным алгоритмом
+    Euclid e(a, an, b, bn, false);
+    while (e.y_size() != 0 && e.x_size() > 1)
+        e.step();
+
+    if (e.y_size() == 0) {
+        std::copy(e.x(), e.x() + e.x_size(), r);
+        return e.x_size();
     }
+    r[0] = gcd_1(e.x()[0], e.y()[0]);
+    return 1;
+}
+
+bool modinv(uint64_t* r, const uint64_t* a, int an, const uint64_t* m, int n) {
+    an = significant(a, an);
+    if (an == 0) return false;
+
+    Euclid e(m, n, a, an, true);
+    while (e.y_size() != 0)
+        e.step();
+    if (e.x_size() != 1 || e.x()[0] != 1) return false;
+
+    // коэффициент отрицателен — берём m - |u0|
+    if (e.steps() % 2)
+        std::copy(e.u0(), e.u0() + n, r);
+    else
+        sub(r, m, e.u0(), n);
+    return true;
+}
+
+// Простые меньше kSmallPrimeLimit — решетом при компиляции
+static constexpr int kSmallPrimeLimit = 1 << 12;
 
+static constexpr std::array<bool, kSmallPrimeLimit> small_sieve() {
+    std::array<bool, kSmallPrimeLimit> composite{};
+    composite[0] = composite[1] = true;
+    for (int p = 2; p * p < kSmallPrimeLimit; ++p)
+        if (!composite[p])
+            for (int k = p * p; k < kSmallPrimeLimit; k += p)
+                composite[k] = true;
+
+    return composite;
+}
+
+static constexpr int kSmallPrimeCount = [] {
+    int count = 0;
+    for (bool composite : small_sieve())
+        count += !composite;
+    return count;
+}();
+
+static constexpr std::array<uint16_t, kSmallPrimeCount> kSmallPrimes = [] {
+    std::array<uint16_t, kSmallPrimeCount> primes{};
+    std::array<bool, kSmallPrimeLimit> composite = small_sieve();
+    for (int i = 0, k = 0; i < kSmallPrimeLimit; ++i)
+        if (!composite[i]) primes[k++] = uint16_t(i);
+    return primes;
+}();
+
+// Нечётные простые таблицы, собранные в произведения до 2^64: остаток числа
+// по произведению — одно деление на слово числа, а дальше проверка каждого
+// простого идёт по этому остатку в одном слове. primes[first..last).
+struct PrimeGroup {
+    uint64_t product;
+    int first;
+    int last;
+};
+
+struct PrimeGroups {
+    std::array<PrimeGroup, kSmallPrimeCount> groups;
+    int count;
+};
+
+static constexpr PrimeGroups kPrimeGroups = [] {
+    PrimeGroups r{};
+    for (int i = 1; i < kSmallPrimeCount;) {
+        PrimeGroup group{1, i, i};
+        while (group.last < kSmallPrimeCount && group.product <= ~uint64_t(0) / kSmallPrimes[group.last])
+            group.product *= kSmallPrimes[group.last++];
+        r.groups[r.count++] = group;
+        i = group.last;
+    }
     return r;
+}();
+
+// Делится ли нечётное a на нечётное простое из таблицы
+static bool has_small_factor(const uint64_t* a, int n) {
+    for (int g = 0; g < kPrimeGroups.count; ++g) {
+        const PrimeGroup& group = kPrimeGroups.groups[g];
+        uint64_t rem = 0;
+        for (int i = n - 1; i >= 0; --i)
+            div_wide(rem, a[i], group.product, rem);
+        for (int k = group.first; k < group.last; ++k)
+            if (rem % kSmallPrimes[k] == 0) return true;
+    }
+
+    return false;
 }
 
-uint2022_t operator*(const uint2022_t& a, const uint2022_t& b) {
-    uint2022_t r;
-    for (int i = 0; i < uint2022_t::SIZE; ++i) {
+// Сильная проверка Ферма нечётного m > kSmallPrimeLimit из n слов по
+// основаниям bases. Разложение m - 1 = d·2^s и константы Монтгомери
+// считаются один раз на все основания. Основание — одно слово, поэтому
+// умножение на него при возведении в степень — умножение на слово и
+// остаток с одним словом частного, а не полное умножение по модулю.
+static bool miller_rabin(const uint64_t* m, int n, const uint16_t* bases, int count) {
+    uint64_t inv = mont_inverse(m[0]);
+    std::vector<uint64_t> buffer(7 * size_t(n) + 5);
+    uint64_t* one = buffer.data();      // R mod m
+    uint64_t* minus_one = one + n;      // (m - 1)R mod m
+    uint64_t* d = minus_one + n;
+    uint64_t* x = d + n;
+    uint64_t* t = x + n;                // n + 1 слов
+    uint64_t* q = t + n + 1;            // 2 слова
+    uint64_t* work = q + 2;             // 2n + 2 слов
+
+    mont_r2(x, m, n);
+    mont_redc(one, x, m, n, inv);
+    sub(minus_one, m, one, n);
+
+    std::copy(m, m + n, d);
+    d[0] -= 1;
+    int s = 0;
+    while (d[s / 64] == 0) s += 64;
+    s += __builtin_ctzll(d[s / 64]);
+    shift_right(d, d, n, s / 64, s % 64);
+    int dn = significant(d, n);
+    int top = dn * 64 - 1 - __builtin_clzll(d[dn - 1]);
+
+    // x = x·base mod m; в форме Монтгомери умножение на обычное число
+    // оставляет результат в той же форме
+    auto mul_base = [&](uint64_t base) {
+        t[n] = mul_1(t, x, n, base, 0);
+        if (n == 1)
+            x[0] = divmod_1(q, t, 2, m[0]);
+        else
+            divmod(q, x, t, n + 1, m, n, work);
+    };
+
+    for (int b = 0; b < count; ++b) {
+        std::copy(one, one + n, x);
+        mul_base(bases[b]);
+        for (int i = top - 1; i >= 0; --i) {
+            mont_sqr(x, x, m, n, inv);
+            if ((d[i / 64] >> (i % 64)) & 1) mul_base(bases[b]);
+        }
+
+        if (compare(x, n, one, n) == 0 || compare(x, n, minus_one, n) == 0) continue;
+
+        bool witness = true;
+        for (int j = 1; j < s && witness; ++j) {
+            mont_sqr(x, x, m, n, inv);
+            if (compare(x, n, minus_one, n) == 0) witness = false;
+            else if (compare(x, n, one, n) == 0) break;
+        }
+        if (witness) return false;
+    }
+
+    return true;
+}
+
+bool is_probable_prime(const uint64_t* a, int n, int rounds) {
+    n = significant(a, n);
+    if (n == 0) return false;
+    if (n == 1 && a[0] < uint64_t(kSmallPrimeLimit))
+        return std::binary_search(kSmallPrimes.begin(), kSmallPrimes.end(), a[0]);
+    if (a[0] % 2 == 0 || has_small_factor(a, n)) return false;
+    if (n == 1 && a[0] < uint64_t(kSmallPrimeLimit) * kSmallPrimeLimit) return true;
+
+    // до 2^64 первые 12 простых оснований дают точный ответ
+    int count = n == 1 ? 12 : std::clamp(rounds, 1, kSmallPrimeCount);
+    return miller_rabin(a, n, kSmallPrimes.data(), count);
+}
+
+// Пакеты чисел: слово i числа l лежит в a[i * lanes + l]. AVX2 обрабатывает
+// четыре числа за раз, перенос каждого числа живёт в своей дорожке регистра;
+// оставшиеся числа и процессоры без AVX2 идут скалярным путём.
+
+static void batch_add_scalar(uint64_t* r, const uint64_t* a, const uint64_t* b, int size, int lanes, int from) {
+    for (int l = from; l < lanes; ++l) {
+        unsigned char carry = 0;
+        for (int i = 0; i < size; ++i)
+            r[i * lanes + l] = add_carry(a[i * lanes + l], b[i * lanes + l], carry);
+    }
+}
+
+static void batch_sub_scalar(uint64_t* r, const uint64_t* a, const uint64_t* b, int size, int lanes, int from) {
+    for (int l = from; l < lanes; ++l) {
+        unsigned char borrow = 0;
+        for (int i = 0; i < size; ++i)
+            r[i * lanes + l] = sub_borrow(a[i * lanes + l], b[i * lanes + l], borrow);
+    }
+}
+
+static void batch_mul_1_scalar(uint64_t* r, const uint64_t* a, int size, int lanes, uint32_t m, int from) {
+    for (int l = from; l < lanes; ++l) {
         uint64_t carry = 0;
+        for (int i = 0; i < size; ++i)
+            r[i * lanes + l] = mul_add(a[i * lanes + l], m, 0, carry);
+    }
+}
 
-        for (int j = 0; j + i < uint2022_t::SIZE; ++j) {
-            uint64_t t = (uint64_t)a.data[i] * b.data[j] + r.data[i + j] + carry;
-            r.data[i + j] = uint32_t(t);
-            carry = t >> 32;
+static void batch_compare_scalar(signed char* out, const uint64_t* a, const uint64_t* b, int size, int lanes, int from) {
+    for (int l = from; l < lanes; ++l) {
+        out[l] = 0;
+        for (int i = size - 1; i >= 0; --i) {
+            uint64_t x = a[i * lanes + l];
+            uint64_t y = b[i * lanes + l];
+            if (x != y) {
+                out[l] = x < y ? -1 : 1;
+                break;
+            }
         }
     }
+}
 
-    return r;
+#if defined(__x86_64__)
+// Беззнаковое a > b: в AVX2 есть только знаковое сравнение 64-битных дорожек
+__attribute__((target("avx2")))
+static inline __m256i greater_u64(__m256i a, __m256i b) {
+    const __m256i sign = _mm256_set1_epi64x(int64_t(1) << 63);
+    return _mm256_cmpgt_epi64(_mm256_xor_si256(a, sign), _mm256_xor_si256(b, sign));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i load4(const uint64_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
 }
 
-uint2022_t operator/(const uint2022_t& a, const uint2022_t& b) {
-    uint2022_t zero;
-    uint2022_t one = from_uint(1);
-    uint2022_t dividend = a;
-    uint2022_t divisor = b;
-    uint2022_t q;
+__attribute__((target("avx2")))
+static inline void store4(uint64_t* p, __m256i v) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+}
 
-    if (divisor == zero) return q;
+// Перенос хранится маской: все единицы — перенос есть. Вычитание маски
+// прибавляет единицу, а переполнение от неё бывает только у суммы 2^64 - 1.
+__attribute__((target("avx2")))
+static int batch_add_avx2(uint64_t* r, const uint64_t* a, const uint64_t* b, int size, int lanes) {
+    const __m256i ones = _mm256_set1_epi64x(-1);
+    int l = 0;
 
-    while (!(dividend < divisor)) {
-        dividend = dividend - divisor;
-        q = q + one;
+    for (; l + 4 <= lanes; l += 4) {
+        __m256i carry = _mm256_setzero_si256();
+        for (int i = 0; i < size; ++i) {
+            __m256i x = load4(a + i * lanes + l);
+            __m256i s = _mm256_add_epi64(x, load4(b + i * lanes + l));
+            __m256i overflow = greater_u64(x, s);
+            overflow = _mm256_or_si256(overflow, _mm256_and_si256(carry, _mm256_cmpeq_epi64(s, ones)));
+            store4(r + i * lanes + l, _mm256_sub_epi64(s, carry));
+            carry = overflow;
+        }
     }
 
-    return q;
+    return l;
 }
 
-bool operator==(const uint2022_t& a, const uint2022_t& b) {
-    for (int i = 0; i < uint2022_t::SIZE; ++i)
-        if (a.data[i] != b.data[i]) return false;
+// Заём — так же маской; вычитание единицы заёма уходит в минус только у нуля
+__attribute__((target("avx2")))
+static int batch_sub_avx2(uint64_t* r, const uint64_t* a, const uint64_t* b, int size, int lanes) {
+    const __m256i zero = _mm256_setzero_si256();
+    int l = 0;
 
-    return true;
+    for (; l + 4 <= lanes; l += 4) {
+        __m256i borrow = zero;
+        for (int i = 0; i < size; ++i) {
+            __m256i x = load4(a + i * lanes + l);
+            __m256i y = load4(b + i * lanes + l);
+            __m256i d = _mm256_sub_epi64(x, y);
+            __m256i under = greater_u64(y, x);
+            under = _mm256_or_si256(under, _mm256_and_si256(borrow, _mm256_cmpeq_epi64(d, zero)));
+            store4(r + i * lanes + l, _mm256_add_epi64(d, borrow));
+            borrow = under;
+        }
+    }
+
+    return l;
 }
 
-bool operator!=(const uint2022_t& a, const uint2022_t& b) {
-    return !(a == b);
+// Слово режется на половины по 32 бита, и обе умножаются на m через
+// _mm256_mul_epu32: x * m = lo + (hi << 32), перенос меньше 2^32 + 2
+__attribute__((target("avx2")))
+static int batch_mul_1_avx2(uint64_t* r, const uint64_t* a, int size, int lanes, uint32_t m) {
+    const __m256i factor = _mm256_set1_epi64x(m);
+    int l = 0;
+
+    for (; l + 4 <= lanes; l += 4) {
+        __m256i carry = _mm256_setzero_si256();
+        for (int i = 0; i < size; ++i) {
+            __m256i x = load4(a + i * lanes + l);
+            __m256i lo = _mm256_mul_epu32(x, factor);
+            __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), factor);
+
+            __m256i s = _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+            __m256i overflow1 = greater_u64(lo, s);
+            __m256i t = _mm256_add_epi64(s, carry);
+            __m256i overflow2 = greater_u64(carry, t);
+
+            store4(r + i * lanes + l, t);
+            carry = _mm256_sub_epi64(_mm256_sub_epi64(_mm256_srli_epi64(hi, 32), overflow1), overflow2);
+        }
+    }
+
+    return l;
 }
 
-bool operator<(const uint2022_t& a, const uint2022_t& b) {
-    for (int i = uint2022_t::SIZE - 1; i >= 0; --i) {
-        if (a.data[i] < b.data[i]) return true;
-        if (a.data[i] > b.data[i]) return false;
+// Сравнение от старших слов к младшим; выходим, когда решены все четыре дорожки
+__attribute__((target("avx2")))
+static int batch_compare_avx2(signed char* out, const uint64_t* a, const uint64_t* b, int size, int lanes) {
+    int l = 0;
+
+    for (; l + 4 <= lanes; l += 4) {
+        __m256i less = _mm256_setzero_si256();
+        __m256i greater = _mm256_setzero_si256();
+        for (int i = size - 1; i >= 0; --i) {
+            __m256i x = load4(a + i * lanes + l);
+            __m256i y = load4(b + i * lanes + l);
+            __m256i open = _mm256_xor_si256(_mm256_or_si256(less, greater), _mm256_set1_epi64x(-1));
+            less = _mm256_or_si256(less, _mm256_and_si256(open, greater_u64(y, x)));
+            greater = _mm256_or_si256(greater, _mm256_and_si256(open, greater_u64(x, y)));
+            if (_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_or_si256(less, greater))) == 0xF) break;
+        }
+
+        int lt = _mm256_movemask_pd(_mm256_castsi256_pd(less));
+        int gt = _mm256_movemask_pd(_mm256_castsi256_pd(greater));
+        for (int k = 0; k < 4; ++k)
+            out[l + k] = (lt >> k) & 1 ? -1 : (gt >> k) & 1 ? 1 : 0;
     }
 
-    return false;
+    return l;
 }
 
-std::ostream& operator<<(std::ostream& stream, const uint2022_t& value) {
-    uint2022_t temp = value;
-    uint2022_t zero;
+static const bool kHaveAvx2 = __builtin_cpu_supports("avx2");
+#endif
+
+void batch_add(uint64_t* r, const uint64_t* a, const uint64_t* b, int size, int lanes) {
+    int done = 0;
+#if defined(__x86_64__)
+    if (kHaveAvx2) done = batch_add_avx2(r, a, b, size, lanes);
+#endif
+    batch_add_scalar(r, a, b, size, lanes, done);
+}
+
+void batch_sub(uint64_t* r, const uint64_t* a, const uint64_t* b, int size, int lanes) {
+    int done = 0;
+#if defined(__x86_64__)
+    if (kHaveAvx2) done = batch_sub_avx2(r, a, b, size, lanes);
+#endif
+    batch_sub_scalar(r, a, b, size, lanes, done);
+}
+
+void batch_mul_1(uint64_t* r, const uint64_t* a, int size, int lanes, uint32_t m) {
+    int done = 0;
+#if defined(__x86_64__)
+    if (kHaveAvx2) done = batch_mul_1_avx2(r, a, size, lanes, m);
+#endif
+    batch_mul_1_scalar(r, a, size, lanes, m, done);
+}
+
+void batch_compare(signed char* out, const uint64_t* a, const uint64_t* b, int size, int lanes) {
+    int done = 0;
+#if defined(__x86_64__)
+    if (kHaveAvx2) done = batch_compare_avx2(out, a, b, size, lanes);
+#endif
+    batch_compare_scalar(out, a, b, size, lanes, done);
+}
+
+std::string to_decimal(const uint64_t* a, int n) {
     std::string s;
+    n = significant(a, n);
 
-    while (temp != zero) {
-        uint64_t rem = 0;
-        for (int i = uint2022_t::SIZE - 1; i >= 0; --i) {
-            uint64_t cur = (rem << 32) | temp.data[i];
-            temp.data[i] = uint32_t(cur / 10);
-            rem = cur % 10;
+    if (n == 0) {
+        s = "0";
+    } else if (n <= kPrintSplitLimbs) {
+        print_chunks(s, std::vector<uint64_t>(a, a + n), 0);
+    } else {
+        // 10^(19·2^k) занимает около 2^k слов: степени до ~n слов хватает
+        size_t count = 1;
+        while ((size_t(1) << count) <= size_t(n)) ++count;
+        print_split(s, std::vector<uint64_t>(a, a + n), 0, chunk_powers(2 * n, count));
+    }
+
+    return s;
+}
+
+std::string to_hex(const uint64_t* a, int n) {
+    static const char kDigits[] = "0123456789abcdef";
+    n = significant(a, n);
+    if (n == 0) return "0";
+
+    std::string s(size_t(n) * 16, '0');
+    for (int i = 0; i < n; ++i)
+        for (int k = 0; k < 16; ++k)
+            s[s.size() - 1 - (size_t(i) * 16 + k)] = kDigits[(a[i] >> (4 * k)) & 0xF];
+
+    s.erase(0, s.find_first_not_of('0'));
+    return s;
+}
+
+// На little-endian машине слова уже лежат в памяти нужными байтами
+void store_bytes(uint8_t* bytes, const uint64_t* a, int n) {
+    if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(bytes, a, size_t(n) * 8);
+    } else {
+        for (int i = 0; i < n; ++i)
+            for (int k = 0; k < 8; ++k)
+                bytes[i * 8 + k] = uint8_t(a[i] >> (8 * k));
+    }
+}
+
+void load_bytes(uint64_t* a, const uint8_t* bytes, int n) {
+    if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(a, bytes, size_t(n) * 8);
+    } else {
+        for (int i = 0; i < n; ++i) {
+            a[i] = 0;
+            for (int k = 0; k < 8; ++k)
+                a[i] |= uint64_t(bytes[i * 8 + k]) << (8 * k);
         }
-        s.push_back(char('0' + rem));
+    }
+}
+
+}  // namespace limb
+
+biguint_t::biguint_t(const biguint_t& other) : data_(inline_) {
+    reserve(other.size_);
+    std::copy(other.data_, other.data_ + other.size_, data_);
+    size_ = other.size_;
+}
+
+biguint_t::biguint_t(biguint_t&& other) noexcept : data_(inline_) {
+    *this = std::move(other);
+}
+
+biguint_t& biguint_t::operator=(const biguint_t& other) {
+    if (this != &other) {
+        reserve(other.size_);
+        std::copy(other.data_, other.data_ + other.size_, data_);
+        size_ = other.size_;
+    }
+
+    return *this;
+}
+
+// Буфер в куче забирается целиком; короткое число копируется
+biguint_t& biguint_t::operator=(biguint_t&& other) noexcept {
+    if (this == &other) return *this;
+
+    if (other.is_inline()) {
+        std::copy(other.data_, other.data_ + other.size_, data_);
+    } else {
+        if (!is_inline()) delete[] data_;
+        data_ = other.data_;
+        capacity_ = other.capacity_;
+        other.data_ = other.inline_;
+        other.capacity_ = kInline;
+    }
+    size_ = other.size_;
+    other.size_ = 0;
+
+    return *this;
+}
+
+biguint_t::~biguint_t() {
+    if (!is_inline()) delete[] data_;
+}
+
+void biguint_t::reserve(int n) {
+    if (n <= capacity_) return;
+
+    int capacity = std::max(n, 2 * capacity_);
+    uint64_t* buffer = new uint64_t[capacity];
+    std::copy(data_, data_ + size_, buffer);
+    if (!is_inline()) delete[] data_;
+    data_ = buffer;
+    capacity_ = capacity;
+}
+
+biguint_t biguint_t::from_uint(uint64_t value) {
+    biguint_t r;
+    r.data_[0] = value;
+    r.size_ = value ? 1 : 0;
+    return r;
+}
+
+biguint_t biguint_t::from_words(const uint64_t* words, int n) {
+    biguint_t r;
+    r.reserve(n);
+    std::copy(words, words + n, r.data_);
+    r.trim(n);
+    return r;
+}
+
+// 19 цифр всегда помещаются в слово
+biguint_t biguint_t::from_string(const char* buff) {
+    biguint_t r;
+    int n = int(strlen(buff) / limb::kChunkDigits) + 1;
+    r.reserve(n);
+    r.size_ = limb::from_decimal(r.data_, n, buff);
+    return r;
+}
+
+biguint_t biguint_t::from_hex(const char* buff) {
+    if (buff[0] == '0' && (buff[1] == 'x' || buff[1] == 'X')) buff += 2;
+
+    biguint_t r;
+    size_t len = strlen(buff);
+    int n = int(len / 16) + 1;
+    r.reserve(n);
+    r.size_ = limb::parse_hex(r.data_, n, buff, len);
+    return r;
+}
+
+biguint_t& biguint_t::operator+=(const biguint_t& other) {
+    int n = std::max(size_, other.size_);
+    reserve(n + 1);
+    std::fill(data_ + size_, data_ + n, 0);
+    data_[n] = limb::add_to(data_, n, other.data_, other.size_);
+    trim(n + 1);
+
+    return *this;
+}
+
+biguint_t& biguint_t::operator-=(const biguint_t& other) {
+    if (*this < other) {
+        size_ = 0;
+    } else {
+        limb::sub_from(data_, size_, other.data_, other.size_);
+        trim(size_);
+    }
+
+    return *this;
+}
+
+biguint_t operator*(const biguint_t& a, const biguint_t& b) {
+    biguint_t r;
+    if (a.is_zero() || b.is_zero()) return r;
+
+    int n = a.size_ + b.size_;
+    r.reserve(n);
+    if (&a == &b)
+        limb::sqr(r.data_, n, a.data_, a.size_);
+    else
+        limb::mul(r.data_, n, a.data_, a.size_, b.data_, b.size_);
+    r.trim(n);
+
+    return r;
+}
+
+biguint_t& biguint_t::operator*=(const biguint_t& other) {
+    return *this = *this * other;
+}
+
+void biguint_t::divmod(const biguint_t& a, const biguint_t& b, biguint_t& quotient, biguint_t& remainder) {
+    quotient.size_ = 0;
+    remainder.size_ = 0;
+    if (b.is_zero()) return;
+    if (a < b) {
+        remainder = a;
+        return;
+    }
+
+    int an = a.size_;
+    int bn = b.size_;
+    quotient.reserve(an - bn + 1);
+    if (bn == 1) {
+        remainder = from_uint(limb::divmod_1(quotient.data_, a.data_, an, b.data_[0]));
+        quotient.trim(an);
+        return;
     }
 
-    if (s.empty()) s = "0";
-    std::reverse(s.begin(), s.end());
-    stream << s;
+    remainder.reserve(bn);
+    std::vector<uint64_t> work(an + bn + 1);
+    limb::divmod(quotient.data_, remainder.data_, a.data_, an, b.data_, bn, work.data());
+    quotient.trim(an - bn + 1);
+    remainder.trim(bn);
+}
+
+biguint_t& biguint_t::operator/=(const biguint_t& other) {
+    biguint_t quotient;
+    biguint_t remainder;
+    divmod(*this, other, quotient, remainder);
+    return *this = std::move(quotient);
+}
+
+biguint_t& biguint_t::operator%=(const biguint_t& other) {
+    biguint_t quotient;
+    biguint_t remainder;
+    divmod(*this, other, quotient, remainder);
+    return *this = std::move(remainder);
+}
+
+biguint_t& biguint_t::operator<<=(size_t shift) {
+    if (size_ == 0) return *this;
+
+    int words = int(shift / 64);
+    int n = size_ + words + 1;
+    reserve(n);
+    std::fill(data_ + size_, data_ + n, 0);
+    limb::shift_left(data_, data_, n, words, int(shift % 64));
+    trim(n);
+
+    return *this;
+}
+
+biguint_t& biguint_t::operator>>=(size_t shift) {
+    shift = std::min(shift, size_t(size_) * 64);
+    int words = int(shift / 64);
+    limb::shift_right(data_, data_, size_, words, int(shift % 64));
+    trim(size_ - words);
+
+    return *this;
+}
+
+std::ostream& operator<<(std::ostream& stream, const biguint_t& value) {
+    return stream << limb::to_decimal(value.data(), value.size());
+}
+
+std::string to_hex(const biguint_t& value) {
+    return limb::to_hex(value.data(), value.size());
+}
+
+bigint_t bigint_t::from_int(int64_t value) {
+    uint64_t magnitude = value < 0 ? 0 - uint64_t(value) : uint64_t(value);
+    return bigint_t(biguint_t::from_uint(magnitude), value < 0);
+}
+
+bigint_t bigint_t::from_string(const char* buff) {
+    bool negative = buff[0] == '-';
+    return bigint_t(biguint_t::from_string(buff + (negative ? 1 : 0)), negative);
+}
+
+void bigint_t::add(const bigint_t& other, bool negate) {
+    bool other_negative = other.negative_ != negate;
+
+    if (negative_ == other_negative) {
+        magnitude_ += other.magnitude_;
+    } else if (magnitude_ >= other.magnitude_) {
+        magnitude_ -= other.magnitude_;
+    } else {
+        magnitude_ = other.magnitude_ - magnitude_;
+        negative_ = other_negative;
+    }
+
+    if (magnitude_.is_zero()) negative_ = false;
+}
+
+bigint_t& bigint_t::operator+=(const bigint_t& other) {
+    add(other, false);
+    return *this;
+}
+
+bigint_t& bigint_t::operator-=(const bigint_t& other) {
+    add(other, true);
+    return *this;
+}
+
+bigint_t& bigint_t::operator*=(const bigint_t& other) {
+    return *this = *this * other;
+}
+
+bigint_t& bigint_t::operator/=(const bigint_t& other) {
+    return *this = bigint_t(magnitude_ / other.magnitude_, negative_ != other.negative_);
+}
+
+bigint_t& bigint_t::operator%=(const bigint_t& other) {
+    return *this = bigint_t(magnitude_ % other.magnitude_, negative_);
+}
 
-    return stream;
+std::ostream& operator<<(std::ostream& stream, const bigint_t& value) {
+    if (value.negative()) stream << '-';
+    return stream << value.magnitude();
 }
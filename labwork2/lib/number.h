@@ -1,30 +1,1511 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cinttypes>
+#include <cstddef>
 #include <iostream>
+#include <span>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
-struct uint2022_t {
-    static const int SIZE = 64;        // 64×32 = 2048 бит
-    uint32_t data[SIZE];               // младшее слово — data[0]
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// Операции над массивами 64-битных слов, младшее слово первое. Общие для
+// всех ширин: шаблон uint_t только выбирает длину и держит число слов.
+// Всё, что нужно арифметике uint_t, доступно при компиляции: интринсики и
+// ассемблер подменяются на __int128, когда идёт вычисление константы, а
+// Карацуба и быстрое десятичное преобразование работают только в рантайме.
+namespace limb {
+
+// До этой длины циклы по всем словам разворачиваются полностью
+constexpr int kUnrollLimit = 8;
+
+constexpr uint64_t add_carry(uint64_t a, uint64_t b, unsigned char& carry) {
+#if defined(__x86_64__)
+    if (!std::is_constant_evaluated()) {
+        unsigned long long r;
+        carry = _addcarry_u64(carry, a, b, &r);
+        return r;
+    }
+#endif
+    unsigned __int128 t = (unsigned __int128)a + b + carry;
+    carry = (unsigned char)(t >> 64);
+    return uint64_t(t);
+}
+
+constexpr uint64_t sub_borrow(uint64_t a, uint64_t b, unsigned char& borrow) {
+#if defined(__x86_64__)
+    if (!std::is_constant_evaluated()) {
+        unsigned long long r;
+        borrow = _subborrow_u64(borrow, a, b, &r);
+        return r;
+    }
+#endif
+    unsigned __int128 t = (unsigned __int128)a - b - borrow;
+    borrow = (unsigned char)(t >> 127);
+    return uint64_t(t);
+}
+
+// Полное произведение: младшее слово возвращается, старшее — в high
+constexpr uint64_t mul_wide(uint64_t a, uint64_t b, uint64_t& high) {
+#if defined(__BMI2__)
+    if (!std::is_constant_evaluated()) {
+        unsigned long long h;
+        uint64_t low = _mulx_u64(a, b, &h);
+        high = h;
+        return low;
+    }
+#endif
+    unsigned __int128 t = (unsigned __int128)a * b;
+    high = uint64_t(t >> 64);
+    return uint64_t(t);
+}
+
+// a * b + acc + carry; старшее слово уходит в carry
+constexpr uint64_t mul_add(uint64_t a, uint64_t b, uint64_t acc, uint64_t& carry) {
+    uint64_t high;
+    uint64_t low = mul_wide(a, b, high);
+    unsigned char c = 0;
+    low = add_carry(low, acc, c);
+    high += c;
+    c = 0;
+    low = add_carry(low, carry, c);
+    carry = high + c;
+    return low;
+}
+
+template <class F, size_t... I>
+constexpr void unroll(F&& f, std::index_sequence<I...>) {
+    (f(int(I)), ...);
+}
+
+// f(0), f(1), ..., f(N - 1) без цикла
+template <size_t N, class F>
+constexpr void unroll(F&& f) {
+    unroll(f, std::make_index_sequence<N>());
+}
+
+// Число значащих слов среди первых n
+constexpr int significant(const uint64_t* a, int n) {
+    while (n > 0 && a[n - 1] == 0) --n;
+    return n;
+}
+
+// (high:low) / d при high < d, остаток — в rem
+constexpr uint64_t div_wide(uint64_t high, uint64_t low, uint64_t d, uint64_t& rem) {
+#if defined(__x86_64__)
+    if (!std::is_constant_evaluated()) {
+        uint64_t q;
+        __asm__("divq %4" : "=a"(q), "=d"(rem) : "a"(low), "d"(high), "rm"(d));
+        return q;
+    }
+#endif
+    unsigned __int128 n = ((unsigned __int128)high << 64) | low;
+    rem = uint64_t(n % d);
+    return uint64_t(n / d);
+}
+
+// r -= a * m, возвращает слово заёма
+constexpr uint64_t submul_1(uint64_t* r, const uint64_t* a, int n, uint64_t m) {
+    uint64_t carry = 0;
+    for (int i = 0; i < n; ++i) {
+        uint64_t high;
+        uint64_t low = mul_wide(a[i], m, high);
+        unsigned char c = 0;
+        low = add_carry(low, carry, c);
+        high += c;
+        c = 0;
+        r[i] = sub_borrow(r[i], low, c);
+        carry = high + c;
+    }
+
+    return carry;
+}
+
+// Сравнение чисел из an и bn значащих слов
+constexpr int compare(const uint64_t* a, int an, const uint64_t* b, int bn) {
+    if (an != bn) return an < bn ? -1 : 1;
+    for (int i = an - 1; i >= 0; --i)
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+
+    return 0;
+}
+
+// r = a + b на n словах, возвращает перенос
+constexpr uint64_t add(uint64_t* r, const uint64_t* a, const uint64_t* b, int n) {
+    unsigned char carry = 0;
+    for (int i = 0; i < n; ++i)
+        r[i] = add_carry(a[i], b[i], carry);
+
+    return carry;
+}
+
+// r = a - b на n словах, возвращает заём
+constexpr uint64_t sub(uint64_t* r, const uint64_t* a, const uint64_t* b, int n) {
+    unsigned char borrow = 0;
+    for (int i = 0; i < n; ++i)
+        r[i] = sub_borrow(a[i], b[i], borrow);
+
+    return borrow;
+}
+
+// r = a * m + add, возвращает старшее слово
+constexpr uint64_t mul_1(uint64_t* r, const uint64_t* a, int n, uint64_t m, uint64_t add) {
+    uint64_t carry = add;
+    for (int i = 0; i < n; ++i)
+        r[i] = mul_add(a[i], m, 0, carry);
+
+    return carry;
+}
+
+// Столбик: младшие rn слов произведения
+constexpr void mul_basecase(uint64_t* r, int rn, const uint64_t* a, int an, const uint64_t* b, int bn) {
+    std::fill(r, r + rn, 0);
+
+    for (int i = 0; i < an && i < rn; ++i) {
+        uint64_t carry = 0;
+        int j = 0;
+
+        for (; j < bn && i + j < rn; ++j)
+            r[i + j] = mul_add(a[i], b[j], r[i + j], carry);
+        if (i + j < rn) r[i + j] = carry;
+    }
+}
+
+// r = a << (64 * words + bits) на n словах, bits < 64; r может совпадать с a
+constexpr void shift_left(uint64_t* r, const uint64_t* a, int n, int words, int bits) {
+    for (int i = n - 1; i >= words; --i) {
+        uint64_t w = a[i - words] << bits;
+        if (bits && i > words) w |= a[i - words - 1] >> (64 - bits);
+        r[i] = w;
+    }
+    std::fill(r, r + std::min(words, n), 0);
+}
+
+// r = a >> (64 * words + bits) на n словах, bits < 64; r может совпадать с a
+constexpr void shift_right(uint64_t* r, const uint64_t* a, int n, int words, int bits) {
+    for (int i = 0; i + words < n; ++i) {
+        uint64_t w = a[i + words] >> bits;
+        if (bits && i + words + 1 < n) w |= a[i + words + 1] << (64 - bits);
+        r[i] = w;
+    }
+    std::fill(r + std::max(n - words, 0), r + n, 0);
+}
+
+// q = a / d, возвращает остаток; q может совпадать с a
+constexpr uint64_t divmod_1(uint64_t* q, const uint64_t* a, int n, uint64_t d) {
+    uint64_t rem = 0;
+    for (int i = n - 1; i >= 0; --i)
+        q[i] = div_wide(rem, a[i], d, rem);
+
+    return rem;
+}
+
+// Деление столбиком по Кнуту (TAOCP т. 2, 4.3.1, алгоритм D) в системе
+// счисления 2^64. Делитель сдвигается так, чтобы старший бит его старшего
+// слова был единицей: тогда оценка очередной цифры частного по двум старшим
+// словам ошибается не больше чем на 2 и исправляется парой проверок.
+// q — an - bn + 1 слов, r — bn слов. Нужны bn >= 2, ненулевое b[bn - 1]
+// и рабочий буфер на an + bn + 1 слов. Делимое сразу копируется в буфер,
+// поэтому q или r может совпадать с a.
+constexpr void divmod(uint64_t* q, uint64_t* r, const uint64_t* a, int an, const uint64_t* b, int bn, uint64_t* work) {
+    uint64_t* u = work;             // нормализованное делимое, на слово длиннее
+    uint64_t* v = work + an + 1;    // нормализованный делитель
+    int s = __builtin_clzll(b[bn - 1]);
+    int m = an - bn;
+
+    for (int i = bn - 1; i > 0; --i)
+        v[i] = (b[i] << s) | (s ? b[i - 1] >> (64 - s) : 0);
+    v[0] = b[0] << s;
+
+    u[an] = s ? a[an - 1] >> (64 - s) : 0;
+    for (int i = an - 1; i > 0; --i)
+        u[i] = (a[i] << s) | (s ? a[i - 1] >> (64 - s) : 0);
+    u[0] = a[0] << s;
+
+    for (int j = m; j >= 0; --j) {
+        uint64_t qhat;
+        uint64_t rhat;
+        bool rhat_overflow = false;
+
+        if (u[j + bn] >= v[bn - 1]) {
+            qhat = ~uint64_t(0);
+            rhat = u[j + bn - 1] + v[bn - 1];
+            rhat_overflow = rhat < v[bn - 1];
+        } else {
+            qhat = div_wide(u[j + bn], u[j + bn - 1], v[bn - 1], rhat);
+        }
+
+        while (!rhat_overflow) {
+            uint64_t high;
+            uint64_t low = mul_wide(qhat, v[bn - 2], high);
+            if (high < rhat || (high == rhat && low <= u[j + bn - 2])) break;
+
+            --qhat;
+            rhat += v[bn - 1];
+            rhat_overflow = rhat < v[bn - 1];
+        }
+
+        // u[j..j+bn] -= qhat * v
+        uint64_t borrow = submul_1(u + j, v, bn, qhat);
+        unsigned char c = 0;
+        u[j + bn] = sub_borrow(u[j + bn], borrow, c);
+
+        // оценка оказалась на единицу больше: возвращаем делитель обратно
+        if (c) {
+            --qhat;
+            u[j + bn] += add(u + j, u + j, v, bn);
+        }
+
+        q[j] = qhat;
+    }
+
+    for (int i = 0; i < bn; ++i)
+        r[i] = (u[i] >> s) | (s ? u[i + 1] << (64 - s) : 0);
+}
+
+// 10^19 — наибольшая степень десяти в слове: десятичные строки
+// разбираются и печатаются кусками по 19 цифр
+constexpr uint64_t kChunkBase = 10000000000000000000ull;
+constexpr int kChunkDigits = 19;
+
+// Разбор len цифр кусками по 19: одно умножение на слово на каждый кусок
+constexpr int parse_decimal(uint64_t* r, int rn, const char* buff, size_t len) {
+    int used = 0;
+    std::fill(r, r + rn, 0);
+
+    size_t pos = 0;
+    size_t first = len % kChunkDigits ? len % kChunkDigits : kChunkDigits;
+    while (pos < len) {
+        size_t count = pos == 0 ? std::min(first, len) : kChunkDigits;
+        uint64_t chunk = 0;
+        uint64_t scale = 1;
+        for (size_t i = 0; i < count; ++i) {
+            chunk = chunk * 10 + uint64_t(buff[pos + i] - '0');
+            scale *= 10;
+        }
+        pos += count;
+
+        uint64_t carry = mul_1(r, r, used, scale, chunk);
+        if (carry && used < rn) r[used++] = carry;
+        used = significant(r, used);
+    }
+
+    return used;
+}
+
+
+// Разбор len шестнадцатеричных цифр: каждая цифра сразу встаёт на свои
+// четыре бита, без умножений. Цифры старше rn слов отбрасываются.
+constexpr int parse_hex(uint64_t* r, int rn, const char* buff, size_t len) {
+    std::fill(r, r + rn, 0);
+
+    for (size_t k = 0; k < len && k < size_t(rn) * 16; ++k) {
+        char c = buff[len - 1 - k];
+        uint64_t digit = c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10;
+        r[k / 16] |= digit << (k % 16 * 4);
+    }
+
+    return significant(r, rn);
+}
+
+// Младшие rn слов произведения; r не пересекается с a и b. Длинные
+// множители перемножаются по Карацубе.
+void mul(uint64_t* r, int rn, const uint64_t* a, int an, const uint64_t* b, int bn);
+// Младшие rn слов квадрата; r не пересекается с a
+void sqr(uint64_t* r, int rn, const uint64_t* a, int an);
+
+// Разбор десятичной строки в rn слов (лишнее отбрасывается), возвращает число значащих слов
+int from_decimal(uint64_t* r, int rn, const char* buff);
+std::string to_decimal(const uint64_t* a, int n);
+std::string to_hex(const uint64_t* a, int n);
+
+// Размер буфера при потоковом чтении и записи чисел
+constexpr size_t kStreamChunk = size_t(1) << 20;
+
+// Слова в байты little-endian и обратно: bytes — 8 * n байт
+void store_bytes(uint8_t* bytes, const uint64_t* a, int n);
+void load_bytes(uint64_t* a, const uint8_t* bytes, int n);
+
+// Арифметика Монтгомери по нечётному модулю m из n слов, R = 2^(64n).
+// Аргументы — n слов, меньше m; r может совпадать с аргументами.
+// -m^-1 mod 2^64
+uint64_t mont_inverse(uint64_t m0);
+// r = R² mod m
+void mont_r2(uint64_t* r, const uint64_t* m, int n);
+// r = a * b * R^-1 mod m
+void mont_mul(uint64_t* r, const uint64_t* a, const uint64_t* b, const uint64_t* m, int n, uint64_t inv);
+// r = a² * R^-1 mod m
+void mont_sqr(uint64_t* r, const uint64_t* a, const uint64_t* m, int n, uint64_t inv);
+// r = a * R^-1 mod m
+void mont_redc(uint64_t* r, const uint64_t* a, const uint64_t* m, int n, uint64_t inv);
+
+// НОД по Лемеру: r — max(an, bn) слов, возвращает число значащих слов
+int gcd(uint64_t* r, const uint64_t* a, int an, const uint64_t* b, int bn);
+// r = a^-1 mod m для a < m из n слов; false, если НОД(a, m) != 1
+bool modinv(uint64_t* r, const uint64_t* a, int an, const uint64_t* m, int n);
+// Пробное деление на простые до 4096, затем Миллер–Рабин по первым rounds
+// простым основаниям; до 2^64 ответ точный
+bool is_probable_prime(const uint64_t* a, int n, int rounds);
+constexpr int kMillerRabinRounds = 25;
+
+// Пакеты из lanes чисел по size слов, слово i числа l — a[i * lanes + l].
+// При поддержке AVX2 четыре числа считаются одной командой; r может
+// совпадать с аргументами.
+void batch_add(uint64_t* r, const uint64_t* a, const uint64_t* b, int size, int lanes);
+void batch_sub(uint64_t* r, const uint64_t* a, const uint64_t* b, int size, int lanes);
+void batch_mul_1(uint64_t* r, const uint64_t* a, int size, int lanes, uint32_t m);
+// out[l] = -1, 0 или 1 — знак сравнения чисел l
+void batch_compare(signed char* out, const uint64_t* a, const uint64_t* b, int size, int lanes);
+
+}  // namespace limb
+
+template <size_t Bits>
+struct uint_t {
+    static_assert(Bits > 0, "uint_t needs at least one bit");
+
+    static constexpr int SIZE = int((Bits + 63) / 64);    // число 64-битных слов
+    uint64_t data[SIZE];               // младшее слово — data[0]
+    int used;                          // число значащих слов, data[used..SIZE) — нули
 
     // конструктор по умолчанию
-    uint2022_t() {
+    constexpr uint_t() : data{}, used(0) {}
+
+    // пересчитать used после прямой записи в data
+    constexpr void normalize() {
+        used = limb::significant(data, SIZE);
+    }
+
+    static constexpr uint_t from_uint(uint64_t value) {
+        uint_t r;
+        r.data[0] = value;
+        r.used = value ? 1 : 0;
+        return r;
+    }
+
+    static constexpr uint_t from_string(const char* buff) {
+        uint_t r;
+        if (std::is_constant_evaluated())
+            r.used = limb::parse_decimal(r.data, SIZE, buff, std::char_traits<char>::length(buff));
+        else
+            r.used = limb::from_decimal(r.data, SIZE, buff);
+        return r;
+    }
+
+    // Шестнадцатеричная строка, с префиксом 0x или без
+    static constexpr uint_t from_hex(const char* buff) {
+        if (buff[0] == '0' && (buff[1] == 'x' || buff[1] == 'X')) buff += 2;
+
+        uint_t r;
+        r.used = limb::parse_hex(r.data, SIZE, buff, std::char_traits<char>::length(buff));
+        return r;
+    }
+
+    // Двоичный вид — BYTES байт little-endian, число за числом без разделителей
+    static constexpr size_t BYTES = size_t(SIZE) * 8;
+
+    // Число из bytes; недостающие старшие байты считаются нулями, лишние отбрасываются
+    static uint_t read_bytes(std::span<const uint8_t> bytes) {
+        uint_t r;
+        size_t n = std::min(bytes.size(), BYTES);
+        limb::load_bytes(r.data, bytes.data(), int(n / 8));
+        for (size_t i = n / 8 * 8; i < n; ++i)
+            r.data[i / 8] |= uint64_t(bytes[i]) << (i % 8 * 8);
+        r.normalize();
+        return r;
+    }
+
+    // Младшие bytes.size() байт числа (не больше BYTES), остаток bytes — нули
+    void write_bytes(std::span<uint8_t> bytes) const {
+        size_t n = std::min(bytes.size(), BYTES);
+        limb::store_bytes(bytes.data(), data, int(n / 8));
+        for (size_t i = n / 8 * 8; i < n; ++i)
+            bytes[i] = uint8_t(data[i / 8] >> (i % 8 * 8));
+        std::fill(bytes.begin() + n, bytes.end(), 0);
+    }
+
+    // Массив чисел из bytes, по BYTES байт на число. Возвращает число
+    // прочитанных значений: полных записей в bytes может быть меньше.
+    static size_t read_bytes(std::span<const uint8_t> bytes, std::span<uint_t> values) {
+        size_t count = std::min(values.size(), bytes.size() / BYTES);
+        for (size_t i = 0; i < count; ++i) {
+            limb::load_bytes(values[i].data, bytes.data() + i * BYTES, SIZE);
+            values[i].normalize();
+        }
+        return count;
+    }
+
+    // Массив чисел в bytes, по BYTES байт на число; возвращает число записанных
+    static size_t write_bytes(std::span<const uint_t> values, std::span<uint8_t> bytes) {
+        size_t count = std::min(values.size(), bytes.size() / BYTES);
+        for (size_t i = 0; i < count; ++i)
+            limb::store_bytes(bytes.data() + i * BYTES, values[i].data, SIZE);
+        return count;
+    }
+
+    // То же для потока: записи идут через буфер кусками по kStreamChunk байт,
+    // так что на число не приходится ни форматирования, ни отдельного вызова.
+    // Неполная запись в конце потока отбрасывается.
+    static size_t read_bytes(std::istream& stream, std::span<uint_t> values) {
+        std::vector<uint8_t> buffer(std::max(limb::kStreamChunk / BYTES, size_t(1)) * BYTES);
+        size_t done = 0;
+
+        while (done < values.size()) {
+            size_t want = std::min(buffer.size(), (values.size() - done) * BYTES);
+            stream.read(reinterpret_cast<char*>(buffer.data()), std::streamsize(want));
+            size_t count = read_bytes(std::span<const uint8_t>(buffer.data(), size_t(stream.gcount())), values.subspan(done));
+            done += count;
+            if (count * BYTES < want) break;
+        }
+
+        return done;
+    }
+
+    static bool write_bytes(std::ostream& stream, std::span<const uint_t> values) {
+        std::vector<uint8_t> buffer(std::max(limb::kStreamChunk / BYTES, size_t(1)) * BYTES);
+
+        for (size_t done = 0; done < values.size() && stream;) {
+            size_t count = write_bytes(values.subspan(done), buffer);
+            stream.write(reinterpret_cast<const char*>(buffer.data()), std::streamsize(count * BYTES));
+            done += count;
+        }
+
+        return bool(stream);
+    }
+};
+
+template <size_t Bits>
+struct divmod_t {
+    uint_t<Bits> quotient;
+    uint_t<Bits> remainder;
+};
+
+// Составные операторы работают на месте: слова пишутся прямо в левый
+// операнд, и копирование идёт только по значащим словам. Обычные операторы
+// построены на них и принимают левый операнд по значению, так что у a + b
+// нет второго временного числа, а в цикле накопления хватает a += b.
+template <size_t Bits>
+constexpr uint_t<Bits>& operator+=(uint_t<Bits>& a, const uint_t<Bits>& b) {
+    constexpr int size = uint_t<Bits>::SIZE;
+
+    if constexpr (size <= limb::kUnrollLimit) {
+        unsigned char carry = 0;
+        limb::unroll<size>([&](int i) { a.data[i] = limb::add_carry(a.data[i], b.data[i], carry); });
+        a.normalize();
+    } else {
+        int n = std::max(a.used, b.used);
+        uint64_t carry = limb::add(a.data, a.data, b.data, n);
+        if (carry && n < size) a.data[n++] = carry;
+        a.used = limb::significant(a.data, n);
+    }
+
+    return a;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits> operator+(uint_t<Bits> a, const uint_t<Bits>& b) {
+    a += b;
+    return a;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits>& operator-=(uint_t<Bits>& a, const uint_t<Bits>& b) {
+    constexpr int size = uint_t<Bits>::SIZE;
+
+    if constexpr (size <= limb::kUnrollLimit) {
+        unsigned char borrow = 0;
+        limb::unroll<size>([&](int i) { a.data[i] = limb::sub_borrow(a.data[i], b.data[i], borrow); });
+        a.normalize();
+    } else {
+        int n = std::max(a.used, b.used);
+
+        // a < b: заём проходит через все старшие слова
+        if (limb::sub(a.data, a.data, b.data, n)) {
+            for (int i = n; i < size; ++i)
+                a.data[i] = ~uint64_t(0);
+            n = size;
+        }
+        a.used = limb::significant(a.data, n);
+    }
+
+    return a;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits> operator-(uint_t<Bits> a, const uint_t<Bits>& b) {
+    a -= b;
+    return a;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits> operator*(const uint_t<Bits>& a, const uint_t<Bits>& b) {
+    constexpr int size = uint_t<Bits>::SIZE;
+    uint_t<Bits> r;
+
+    if constexpr (size <= limb::kUnrollLimit) {
+        limb::unroll<size>([&](int i) {
+            uint64_t carry = 0;
+            limb::unroll<size>([&](int j) {
+                if (i + j < size) r.data[i + j] = limb::mul_add(a.data[i], b.data[j], r.data[i + j], carry);
+            });
+        });
+        r.normalize();
+    } else {
+        if (std::is_constant_evaluated()) {
+            limb::mul_basecase(r.data, size, a.data, a.used, b.data, b.used);
+        } else {
+            if (&a == &b) return square(a);
+            limb::mul(r.data, size, a.data, a.used, b.data, b.used);
+        }
+        r.used = limb::significant(r.data, std::min(a.used + b.used, size));
+    }
+
+    return r;
+}
+
+// Произведение пишется в буфер на стеке без обнуления и переносится в a
+// по значащим словам
+template <size_t Bits>
+constexpr uint_t<Bits>& operator*=(uint_t<Bits>& a, const uint_t<Bits>& b) {
+    constexpr int size = uint_t<Bits>::SIZE;
+
+    if constexpr (size <= limb::kUnrollLimit) {
+        a = a * b;
+    } else {
+        int n = std::min(a.used + b.used, size);
+        uint64_t t[size];
+
+        if (std::is_constant_evaluated())
+            limb::mul_basecase(t, n, a.data, a.used, b.data, b.used);
+        else if (&a == &b)
+            limb::sqr(t, n, a.data, a.used);
+        else
+            limb::mul(t, n, a.data, a.used, b.data, b.used);
+
+        std::copy(t, t + n, a.data);
+        a.used = limb::significant(a.data, n);
+    }
+
+    return a;
+}
+
+// Квадрат: симметричные произведения слов считаются один раз
+template <size_t Bits>
+constexpr uint_t<Bits> square(const uint_t<Bits>& a) {
+    constexpr int size = uint_t<Bits>::SIZE;
+    uint_t<Bits> r;
+
+    if constexpr (size <= limb::kUnrollLimit) {
+        limb::unroll<size>([&](int i) {
+            uint64_t carry = 0;
+            limb::unroll<size>([&](int j) {
+                if (j > i && i + j < size) r.data[i + j] = limb::mul_add(a.data[i], a.data[j], r.data[i + j], carry);
+            });
+        });
+
+        uint64_t top = 0;
+        limb::unroll<size>([&](int i) {
+            uint64_t w = r.data[i];
+            r.data[i] = (w << 1) | top;
+            top = w >> 63;
+        });
+
+        unsigned char carry = 0;
+        limb::unroll<size>([&](int i) {
+            if (2 * i >= size) return;
+            uint64_t high;
+            uint64_t low = limb::mul_wide(a.data[i], a.data[i], high);
+            r.data[2 * i] = limb::add_carry(r.data[2 * i], low, carry);
+            if (2 * i + 1 < size) r.data[2 * i + 1] = limb::add_carry(r.data[2 * i + 1], high, carry);
+        });
+        r.normalize();
+    } else {
+        if (std::is_constant_evaluated())
+            limb::mul_basecase(r.data, size, a.data, a.used, a.data, a.used);
+        else
+            limb::sqr(r.data, size, a.data, a.used);
+        r.used = limb::significant(r.data, std::min(2 * a.used, size));
+    }
+
+    return r;
+}
+
+// Степень слева направо: квадрат на каждый бит показателя и умножение на
+// основание там, где бит единичный
+template <size_t Bits>
+constexpr uint_t<Bits> pow(const uint_t<Bits>& base, const uint_t<Bits>& exp) {
+    uint_t<Bits> r = uint_t<Bits>::from_uint(1);
+    if (exp.used == 0) return r;
+
+    int top = exp.used * 64 - 1 - __builtin_clzll(exp.data[exp.used - 1]);
+    r = base;
+    for (int i = top - 1; i >= 0; --i) {
+        r = square(r);
+        if ((exp.data[i / 64] >> (i % 64)) & 1) r *= base;
+    }
+
+    return r;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits> pow(const uint_t<Bits>& base, uint64_t exp) {
+    return pow(base, uint_t<Bits>::from_uint(exp));
+}
+
+template <size_t Bits>
+constexpr bool operator==(const uint_t<Bits>& a, const uint_t<Bits>& b) {
+    if (a.used != b.used) return false;
+    for (int i = 0; i < a.used; ++i)
+        if (a.data[i] != b.data[i]) return false;
+
+    return true;
+}
+
+template <size_t Bits>
+constexpr bool operator!=(const uint_t<Bits>& a, const uint_t<Bits>& b) {
+    return !(a == b);
+}
+
+template <size_t Bits>
+constexpr bool operator<(const uint_t<Bits>& a, const uint_t<Bits>& b) {
+    return limb::compare(a.data, a.used, b.data, b.used) < 0;
+}
+
+// Частное и остаток за одно деление. Деление на ноль даёт нули.
+template <size_t Bits>
+constexpr divmod_t<Bits> divmod(const uint_t<Bits>& a, const uint_t<Bits>& b) {
+    divmod_t<Bits> r;
+
+    if (b.used == 0) return r;
+    if (a < b) {
+        r.remainder = a;
+        return r;
+    }
+    if (b.used == 1) {
+        r.remainder = uint_t<Bits>::from_uint(limb::divmod_1(r.quotient.data, a.data, a.used, b.data[0]));
+        r.quotient.used = limb::significant(r.quotient.data, a.used);
+        return r;
+    }
+
+    uint64_t work[2 * uint_t<Bits>::SIZE + 1];
+    limb::divmod(r.quotient.data, r.remainder.data, a.data, a.used, b.data, b.used, work);
+    r.quotient.used = limb::significant(r.quotient.data, a.used - b.used + 1);
+    r.remainder.used = limb::significant(r.remainder.data, b.used);
+
+    return r;
+}
+
+// Частное пишется прямо в a: алгоритм D читает делимое только до первой
+// цифры частного
+template <size_t Bits>
+constexpr uint_t<Bits>& operator/=(uint_t<Bits>& a, const uint_t<Bits>& b) {
+    int an = a.used;
+
+    if (b.used == 0 || a < b) {
+        std::fill(a.data, a.data + an, 0);
+        a.used = 0;
+    } else if (b.used == 1) {
+        limb::divmod_1(a.data, a.data, an, b.data[0]);
+        a.used = limb::significant(a.data, an);
+    } else {
+        uint64_t work[2 * uint_t<Bits>::SIZE + 1];
+        uint64_t r[uint_t<Bits>::SIZE];
+        int qn = an - b.used + 1;
+
+        limb::divmod(a.data, r, a.data, an, b.data, b.used, work);
+        std::fill(a.data + qn, a.data + an, 0);
+        a.used = limb::significant(a.data, qn);
+    }
+
+    return a;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits> operator/(uint_t<Bits> a, const uint_t<Bits>& b) {
+    a /= b;
+    return a;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits>& operator%=(uint_t<Bits>& a, const uint_t<Bits>& b) {
+    int an = a.used;
+
+    if (b.used == 0) {
+        std::fill(a.data, a.data + an, 0);
+        a.used = 0;
+    } else if (a < b) {
+        return a;
+    } else if (b.used == 1) {
+        uint64_t q[uint_t<Bits>::SIZE];
+        uint64_t rem = limb::divmod_1(q, a.data, an, b.data[0]);
+        std::fill(a.data + 1, a.data + an, 0);
+        a.data[0] = rem;
+        a.used = rem ? 1 : 0;
+    } else {
+        uint64_t work[2 * uint_t<Bits>::SIZE + 1];
+        uint64_t q[uint_t<Bits>::SIZE];
+
+        limb::divmod(q, a.data, a.data, an, b.data, b.used, work);
+        std::fill(a.data + b.used, a.data + an, 0);
+        a.used = limb::significant(a.data, b.used);
+    }
+
+    return a;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits> operator%(uint_t<Bits> a, const uint_t<Bits>& b) {
+    a %= b;
+    return a;
+}
+
+// Сдвиги переносят слова целиком и сцепляют соседние слова для остатка
+// сдвига. Биты за старшим словом типа теряются, как при переполнении.
+template <size_t Bits>
+constexpr uint_t<Bits>& operator<<=(uint_t<Bits>& a, size_t shift) {
+    constexpr int size = uint_t<Bits>::SIZE;
+    if (a.used == 0) return a;
+
+    shift = std::min(shift, size_t(size) * 64);
+    int words = int(shift / 64);
+    int n = std::min(a.used + words + 1, size);
+    limb::shift_left(a.data, a.data, n, words, int(shift % 64));
+    a.used = limb::significant(a.data, n);
+
+    return a;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits> operator<<(uint_t<Bits> a, size_t shift) {
+    a <<= shift;
+    return a;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits>& operator>>=(uint_t<Bits>& a, size_t shift) {
+    constexpr int size = uint_t<Bits>::SIZE;
+
+    shift = std::min(shift, size_t(size) * 64);
+    int words = int(shift / 64);
+    limb::shift_right(a.data, a.data, a.used, words, int(shift % 64));
+    a.used = limb::significant(a.data, std::max(a.used - words, 0));
+
+    return a;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits> operator>>(uint_t<Bits> a, size_t shift) {
+    a >>= shift;
+    return a;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits>& operator&=(uint_t<Bits>& a, const uint_t<Bits>& b) {
+    int n = std::min(a.used, b.used);
+    for (int i = 0; i < n; ++i)
+        a.data[i] &= b.data[i];
+    std::fill(a.data + n, a.data + a.used, 0);
+    a.used = limb::significant(a.data, n);
+
+    return a;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits> operator&(uint_t<Bits> a, const uint_t<Bits>& b) {
+    a &= b;
+    return a;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits>& operator|=(uint_t<Bits>& a, const uint_t<Bits>& b) {
+    for (int i = 0; i < b.used; ++i)
+        a.data[i] |= b.data[i];
+    a.used = std::max(a.used, b.used);
+
+    return a;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits> operator|(uint_t<Bits> a, const uint_t<Bits>& b) {
+    a |= b;
+    return a;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits>& operator^=(uint_t<Bits>& a, const uint_t<Bits>& b) {
+    for (int i = 0; i < b.used; ++i)
+        a.data[i] ^= b.data[i];
+    a.used = limb::significant(a.data, std::max(a.used, b.used));
+
+    return a;
+}
+
+template <size_t Bits>
+constexpr uint_t<Bits> operator^(uint_t<Bits> a, const uint_t<Bits>& b) {
+    a ^= b;
+    return a;
+}
+
+template <size_t Bits>
+std::ostream& operator<<(std::ostream& stream, const uint_t<Bits>& value) {
+    return stream << limb::to_decimal(value.data, value.used);
+}
+
+// Строчные цифры без префикса и ведущих нулей
+template <size_t Bits>
+std::string to_hex(const uint_t<Bits>& value) {
+    return limb::to_hex(value.data, value.used);
+}
+
+// Умножение по нечётному модулю N без деления. Число a хранится в форме
+// Монтгомери aR mod N, R = 2^(64n), n — число слов N; произведение форм
+// делится на R сдвигом по словам, а R² mod N и -N^-1 mod 2^64 считаются
+// один раз в конструкторе. Вся арифметика идёт на n словах модуля, а не на
+// всей ширине типа.
+template <size_t Bits>
+class MontgomeryContext {
+public:
+    // модуль нечётный и больше единицы
+    explicit MontgomeryContext(const uint_t<Bits>& modulus)
+        : modulus_(modulus), n_(modulus.used), inv_(limb::mont_inverse(modulus.data[0])) {
+        limb::mont_r2(r2_.data, modulus_.data, n_);
+        r2_.used = limb::significant(r2_.data, n_);
+        one_ = to_montgomery(uint_t<Bits>::from_uint(1));
+    }
+
+    const uint_t<Bits>& modulus() const {
+        return modulus_;
+    }
+
+    // aR mod N; a может быть больше модуля
+    uint_t<Bits> to_montgomery(const uint_t<Bits>& a) const {
+        if (limb::compare(a.data, a.used, modulus_.data, n_) >= 0)
+            return mulmod(a % modulus_, r2_);
+        return mulmod(a, r2_);
+    }
+
+    // a из формы Монтгомери обратно в обычное число
+    uint_t<Bits> from_montgomery(const uint_t<Bits>& a) const {
+        uint_t<Bits> r;
+        limb::mont_redc(r.data, a.data, modulus_.data, n_, inv_);
+        r.used = limb::significant(r.data, n_);
+        return r;
+    }
+
+    // Произведение двух чисел в форме Монтгомери, результат в той же форме
+    uint_t<Bits> mulmod(const uint_t<Bits>& a, const uint_t<Bits>& b) const {
+        uint_t<Bits> r;
+        limb::mont_mul(r.data, a.data, b.data, modulus_.data, n_, inv_);
+        r.used = limb::significant(r.data, n_);
+        return r;
+    }
+
+    uint_t<Bits> sqrmod(const uint_t<Bits>& a) const {
+        uint_t<Bits> r;
+        limb::mont_sqr(r.data, a.data, modulus_.data, n_, inv_);
+        r.used = limb::significant(r.data, n_);
+        return r;
+    }
+
+    // base^exp mod N для обычных (не Монтгомери) чисел. Показатель читается
+    // скользящим окном: нечётные степени base^1, base^3, ..., base^(2^k - 1)
+    // считаются заранее, и на каждое окно из k бит приходится одно умножение.
+    uint_t<Bits> powmod(const uint_t<Bits>& base, const uint_t<Bits>& exp) const {
+        if (exp.used == 0) return from_montgomery(one_);
+
+        int top = exp.used * 64 - 1 - __builtin_clzll(exp.data[exp.used - 1]);
+        auto bit = [&](int i) { return int((exp.data[i / 64] >> (i % 64)) & 1); };
+
+        int k = top < 24 ? 1 : top < 80 ? 3 : top < 240 ? 4 : top < 672 ? 5 : 6;
+        std::vector<uint_t<Bits>> odd(size_t(1) << (k - 1));
+        odd[0] = to_montgomery(base);
+        if (odd.size() > 1) {
+            uint_t<Bits> base2 = sqrmod(odd[0]);
+            for (size_t i = 1; i < odd.size(); ++i)
+                odd[i] = mulmod(odd[i - 1], base2);
+        }
+
+        uint_t<Bits> r = one_;
+        bool started = false;
+        for (int i = top; i >= 0;) {
+            if (!bit(i)) {
+                r = sqrmod(r);
+                --i;
+                continue;
+            }
+
+            // окно [j, i] заканчивается единичным битом
+            int j = std::max(i - k + 1, 0);
+            while (!bit(j)) ++j;
+            int window = 0;
+            for (int l = i; l >= j; --l)
+                window = window * 2 + bit(l);
+
+            if (started) {
+                for (int l = j; l <= i; ++l)
+                    r = sqrmod(r);
+                r = mulmod(r, odd[window / 2]);
+            } else {
+                r = odd[window / 2];
+                started = true;
+            }
+            i = j - 1;
+        }
+
+        return from_montgomery(r);
+    }
+
+private:
+    uint_t<Bits> modulus_;
+    uint_t<Bits> r2_;       // R² mod N
+    uint_t<Bits> one_;      // R mod N — единица в форме Монтгомери
+    int n_;
+    uint64_t inv_;          // -N^-1 mod 2^64
+};
+
+// base^exp mod modulus. Нечётный модуль — через Монтгомери; чётный — возведением
+// в степень на удвоенной ширине с делением после каждого шага. Модуль 0 даёт 0.
+template <size_t Bits>
+uint_t<Bits> powmod(const uint_t<Bits>& base, const uint_t<Bits>& exp, const uint_t<Bits>& modulus) {
+    if (modulus.used == 0) return uint_t<Bits>();
+    if (modulus.data[0] & 1) return MontgomeryContext<Bits>(modulus).powmod(base, exp);
+
+    using wide_t = uint_t<2 * Bits>;
+    auto widen = [](const uint_t<Bits>& a) {
+        wide_t r;
+        std::copy(a.data, a.data + a.used, r.data);
+        r.used = a.used;
+        return r;
+    };
+
+    wide_t m = widen(modulus);
+    wide_t b = widen(base % modulus);
+    wide_t r = wide_t::from_uint(1) % m;
+    for (int i = exp.used * 64 - 1; i >= 0; --i) {
+        r = square(r) % m;
+        if ((exp.data[i / 64] >> (i % 64)) & 1) r = r * b % m;
+    }
+
+    uint_t<Bits> result;
+    std::copy(r.data, r.data + r.used, result.data);
+    result.used = r.used;
+    return result;
+}
+
+// N чисел uint_t<Bits> в раскладке «структура массивов»: слово i всех чисел
+// лежит подряд, и векторные команды складывают слово i сразу у нескольких
+// чисел, каждое со своим переносом. Переход из скалярного вида и обратно —
+// одно копирование слов.
+template <size_t Bits, size_t N>
+struct uint_batch_t {
+    static constexpr int SIZE = uint_t<Bits>::SIZE;
+    static constexpr int LANES = int(N);
+    alignas(32) uint64_t data[SIZE * N];    // слово i числа lane — data[i * N + lane]
+
+    uint_batch_t() : data{} {}
+
+    void set(int lane, const uint_t<Bits>& value) {
+        for (int i = 0; i < value.used; ++i)
+            data[i * N + lane] = value.data[i];
+        for (int i = value.used; i < SIZE; ++i)
+            data[i * N + lane] = 0;
+    }
+
+    uint_t<Bits> get(int lane) const {
+        uint_t<Bits> r;
         for (int i = 0; i < SIZE; ++i)
-            data[i] = 0;
+            r.data[i] = data[i * N + lane];
+        r.normalize();
+        return r;
+    }
+
+    static uint_batch_t load(const uint_t<Bits>* values) {
+        uint_batch_t r;
+        for (int lane = 0; lane < LANES; ++lane)
+            for (int i = 0; i < values[lane].used; ++i)
+                r.data[i * N + lane] = values[lane].data[i];
+        return r;
+    }
+
+    void store(uint_t<Bits>* values) const {
+        for (int lane = 0; lane < LANES; ++lane)
+            values[lane] = get(lane);
     }
 };
 
+template <size_t Bits, size_t N>
+uint_batch_t<Bits, N>& operator+=(uint_batch_t<Bits, N>& a, const uint_batch_t<Bits, N>& b) {
+    limb::batch_add(a.data, a.data, b.data, a.SIZE, a.LANES);
+    return a;
+}
+
+template <size_t Bits, size_t N>
+uint_batch_t<Bits, N> operator+(uint_batch_t<Bits, N> a, const uint_batch_t<Bits, N>& b) {
+    a += b;
+    return a;
+}
+
+template <size_t Bits, size_t N>
+uint_batch_t<Bits, N>& operator-=(uint_batch_t<Bits, N>& a, const uint_batch_t<Bits, N>& b) {
+    limb::batch_sub(a.data, a.data, b.data, a.SIZE, a.LANES);
+    return a;
+}
+
+template <size_t Bits, size_t N>
+uint_batch_t<Bits, N> operator-(uint_batch_t<Bits, N> a, const uint_batch_t<Bits, N>& b) {
+    a -= b;
+    return a;
+}
+
+template <size_t Bits, size_t N>
+uint_batch_t<Bits, N>& operator*=(uint_batch_t<Bits, N>& a, uint32_t m) {
+    limb::batch_mul_1(a.data, a.data, a.SIZE, a.LANES, m);
+    return a;
+}
+
+template <size_t Bits, size_t N>
+uint_batch_t<Bits, N> operator*(uint_batch_t<Bits, N> a, uint32_t m) {
+    a *= m;
+    return a;
+}
+
+// Знак сравнения по числам: -1, 0 или 1
+template <size_t Bits, size_t N>
+std::array<signed char, N> compare(const uint_batch_t<Bits, N>& a, const uint_batch_t<Bits, N>& b) {
+    std::array<signed char, N> r;
+    limb::batch_compare(r.data(), a.data, b.data, a.SIZE, a.LANES);
+    return r;
+}
+
+namespace detail {
+
+// Свёртка [0, n) по потокам: каждый поток получает кусок не мельче grain и
+// считает reduce(first, count), затем частичные результаты сливаются
+// combine(a, b) попарно, уровень за уровнем, пары одного уровня — тоже в
+// параллель. threads = 0 — по числу ядер.
+template <class T, class Reduce, class Combine>
+T parallel_reduce(size_t n, size_t grain, unsigned threads, const Reduce& reduce, const Combine& combine) {
+    if (threads == 0) threads = std::max(std::thread::hardware_concurrency(), 1u);
+    size_t parts = std::min(size_t(threads), std::max(n / grain, size_t(1)));
+    if (parts <= 1) return reduce(0, n);
+
+    std::vector<T> partial(parts);
+    std::vector<std::thread> workers;
+    for (size_t p = 0; p < parts; ++p) {
+        workers.emplace_back([&, p] {
+            size_t first = n * p / parts;
+            partial[p] = reduce(first, n * (p + 1) / parts - first);
+        });
+    }
+    for (std::thread& worker : workers)
+        worker.join();
+
+    while (partial.size() > 1) {
+        size_t pairs = partial.size() / 2;
+        workers.clear();
+        for (size_t p = 1; p < pairs; ++p)
+            workers.emplace_back([&, p] { combine(partial[2 * p], partial[2 * p + 1]); });
+        combine(partial[0], partial[1]);
+        for (std::thread& worker : workers)
+            worker.join();
+
+        for (size_t p = 1; p < pairs; ++p)
+            partial[p] = partial[2 * p];
+        if (partial.size() % 2) partial[pairs] = partial.back();
+        partial.resize((partial.size() + 1) / 2);
+    }
+
+    return partial[0];
+}
+
+// Произведение leaf(first) * ... * leaf(first + count - 1) сбалансированным
+// деревом: половины перемножаются отдельно, так что множители на каждом
+// уровне одной длины и крупные произведения идут через Карацубу
+template <size_t Bits, class Leaf>
+uint_t<Bits> product_tree(size_t first, size_t count, const Leaf& leaf) {
+    if (count == 0) return uint_t<Bits>::from_uint(1);
+    if (count == 1) return leaf(first);
+
+    size_t half = count / 2;
+    uint_t<Bits> r = product_tree<Bits>(first, half, leaf);
+    r *= product_tree<Bits>(first + half, count - half, leaf);
+    return r;
+}
+
+}  // namespace detail
+
+// Сумма массива по потокам: каждый поток копит свой кусок через +=
+template <size_t Bits>
+uint_t<Bits> parallel_sum(std::span<const uint_t<Bits>> values, unsigned threads = 0) {
+    return detail::parallel_reduce<uint_t<Bits>>(
+        values.size(), 4096, threads,
+        [&](size_t first, size_t count) {
+            uint_t<Bits> r;
+            for (size_t i = first; i < first + count; ++i)
+                r += values[i];
+            return r;
+        },
+        [](uint_t<Bits>& a, const uint_t<Bits>& b) { a += b; });
+}
+
+// Произведение массива: в каждом потоке дерево произведений своего куска,
+// затем дерево над результатами потоков
+template <size_t Bits>
+uint_t<Bits> parallel_product(std::span<const uint_t<Bits>> values, unsigned threads = 0) {
+    return detail::parallel_reduce<uint_t<Bits>>(
+        values.size(), 16, threads,
+        [&](size_t first, size_t count) {
+            return detail::product_tree<Bits>(first, count, [&](size_t i) { return values[i]; });
+        },
+        [](uint_t<Bits>& a, const uint_t<Bits>& b) { a *= b; });
+}
+
+// n! деревом произведений. Подряд идущие множители сначала собираются в
+// слова, пока произведение помещается в 64 бита: листьев в десятки раз
+// меньше, чем чисел от 1 до n.
+template <size_t Bits = 2022>
+uint_t<Bits> factorial(uint64_t n, unsigned threads = 0) {
+    std::vector<uint64_t> words;
+    uint64_t word = 1;
+    for (uint64_t k = 2; k <= n; ++k) {
+        if (word > ~uint64_t(0) / k) {
+            words.push_back(word);
+            word = 1;
+        }
+        word *= k;
+    }
+    words.push_back(word);
+
+    return detail::parallel_reduce<uint_t<Bits>>(
+        words.size(), 16, threads,
+        [&](size_t first, size_t count) {
+            return detail::product_tree<Bits>(first, count, [&](size_t i) { return uint_t<Bits>::from_uint(words[i]); });
+        },
+        [](uint_t<Bits>& a, const uint_t<Bits>& b) { a *= b; });
+}
+
+// НОД(a, b); НОД(a, 0) = a
+template <size_t Bits>
+uint_t<Bits> gcd(const uint_t<Bits>& a, const uint_t<Bits>& b) {
+    uint_t<Bits> r;
+    r.used = limb::gcd(r.data, a.data, a.used, b.data, b.used);
+    return r;
+}
+
+// a^-1 mod modulus расширенным алгоритмом Евклида; 0, если обратного нет
+template <size_t Bits>
+uint_t<Bits> modinv(const uint_t<Bits>& a, const uint_t<Bits>& modulus) {
+    uint_t<Bits> r;
+    if (modulus.used == 0) return r;
+
+    uint_t<Bits> reduced = a % modulus;
+    if (limb::modinv(r.data, reduced.data, reduced.used, modulus.data, modulus.used))
+        r.used = limb::significant(r.data, modulus.used);
+    return r;
+}
+
+// Вероятно ли n простое. Составное число проходит Миллера–Рабина по одному
+// основанию с вероятностью не больше 1/4; основания фиксированы, так что
+// ответ воспроизводим.
+template <size_t Bits>
+bool is_probable_prime(const uint_t<Bits>& n, int rounds = limb::kMillerRabinRounds) {
+    return limb::is_probable_prime(n.data, n.used, rounds);
+}
+
+// Проверка кандидатов по потокам: result[i] — ответ для candidates[i],
+// возвращает число вероятно простых
+template <size_t Bits>
+size_t is_probable_prime(std::span<const uint_t<Bits>> candidates, std::span<bool> result,
+                         int rounds = limb::kMillerRabinRounds, unsigned threads = 0) {
+    return detail::parallel_reduce<size_t>(
+        candidates.size(), 1, threads,
+        [&](size_t first, size_t count) {
+            size_t primes = 0;
+            for (size_t i = first; i < first + count; ++i)
+                primes += result[i] = is_probable_prime(candidates[i], rounds);
+            return primes;
+        },
+        [](size_t& a, size_t b) { a += b; });
+}
+
+using uint2022_t = uint_t<2022>;
+using uint2022_divmod_t = divmod_t<2022>;
+using uint2022_montgomery_t = MontgomeryContext<2022>;
+template <size_t N>
+using uint2022_batch = uint_batch_t<2022, N>;
+
 static_assert(sizeof(uint2022_t) <= 300, "Size of uint2022_t must be no higher than 300 bytes");
 
-uint2022_t from_uint(uint32_t i);
-uint2022_t from_string(const char* buff);
+constexpr uint2022_t from_uint(uint32_t i) {
+    return uint2022_t::from_uint(i);
+}
+
+constexpr uint2022_t from_string(const char* buff) {
+    return uint2022_t::from_string(buff);
+}
+
+constexpr uint2022_t from_hex(const char* buff) {
+    return uint2022_t::from_hex(buff);
+}
+
+inline uint2022_t parallel_sum(std::span<const uint2022_t> values, unsigned threads = 0) {
+    return parallel_sum<2022>(values, threads);
+}
+
+inline uint2022_t parallel_product(std::span<const uint2022_t> values, unsigned threads = 0) {
+    return parallel_product<2022>(values, threads);
+}
+
+inline size_t is_probable_prime(std::span<const uint2022_t> candidates, std::span<bool> result,
+                                int rounds = limb::kMillerRabinRounds, unsigned threads = 0) {
+    return is_probable_prime<2022>(candidates, result, rounds, threads);
+}
+
+// 12345_u2022 и 0x3039_u2022: значение считается при компиляции и попадает
+// в бинарник готовым
+consteval uint2022_t operator""_u2022(const char* digits) {
+    if (digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X')) return uint2022_t::from_hex(digits);
+    return uint2022_t::from_string(digits);
+}
+
+// Беззнаковое число произвольной длины. До kInline слов число хранится в
+// самом объекте без обращения к куче, длиннее — в буфере, который растёт
+// удвоением. Арифметика идёт через те же функции limb, что и у uint_t, так
+// что разбор, печать и умножение (столбик, Карацуба, NTT) общие.
+// Разность a - b при a < b и деление на ноль дают 0.
+class biguint_t {
+public:
+    static constexpr int kInline = 4;
+
+    biguint_t() : data_(inline_) {}
+    biguint_t(const biguint_t& other);
+    biguint_t(biguint_t&& other) noexcept;
+    biguint_t& operator=(const biguint_t& other);
+    biguint_t& operator=(biguint_t&& other) noexcept;
+    ~biguint_t();
+
+    static biguint_t from_uint(uint64_t value);
+    static biguint_t from_string(const char* buff);
+    static biguint_t from_hex(const char* buff);
+    static biguint_t from_words(const uint64_t* words, int n);
+
+    template <size_t Bits>
+    static biguint_t from(const uint_t<Bits>& value) {
+        return from_words(value.data, value.used);
+    }
+
+    // Младшие слова числа; старшие, не поместившиеся в uint_t<Bits>, теряются
+    template <size_t Bits>
+    uint_t<Bits> to() const {
+        uint_t<Bits> r;
+        int n = std::min(size_, uint_t<Bits>::SIZE);
+        std::copy(data_, data_ + n, r.data);
+        r.used = limb::significant(r.data, n);
+        return r;
+    }
+
+    const uint64_t* data() const {
+        return data_;
+    }
+
+    // число значащих слов
+    int size() const {
+        return size_;
+    }
+
+    bool is_zero() const {
+        return size_ == 0;
+    }
+
+    bool is_inline() const {
+        return data_ == inline_;
+    }
+
+    biguint_t& operator+=(const biguint_t& other);
+    biguint_t& operator-=(const biguint_t& other);
+    biguint_t& operator*=(const biguint_t& other);
+    biguint_t& operator/=(const biguint_t& other);
+    biguint_t& operator%=(const biguint_t& other);
+    biguint_t& operator<<=(size_t shift);
+    biguint_t& operator>>=(size_t shift);
+
+    // Частное и остаток за одно деление; quotient и remainder — не a и не b
+    static void divmod(const biguint_t& a, const biguint_t& b, biguint_t& quotient, biguint_t& remainder);
+
+    friend biguint_t operator*(const biguint_t& a, const biguint_t& b);
+
+private:
+    // Место под n слов; содержимое сохраняется, новые слова не обнуляются
+    void reserve(int n);
+    void trim(int n) {
+        size_ = limb::significant(data_, n);
+    }
+
+    uint64_t* data_;
+    int size_ = 0;
+    int capacity_ = kInline;
+    uint64_t inline_[kInline];
+};
+
+inline int compare(const biguint_t& a, const biguint_t& b) {
+    return limb::compare(a.data(), a.size(), b.data(), b.size());
+}
+
+inline bool operator==(const biguint_t& a, const biguint_t& b) {
+    return compare(a, b) == 0;
+}
+
+inline bool operator!=(const biguint_t& a, const biguint_t& b) {
+    return compare(a, b) != 0;
+}
+
+inline bool operator<(const biguint_t& a, const biguint_t& b) {
+    return compare(a, b) < 0;
+}
+
+inline bool operator>(const biguint_t& a, const biguint_t& b) {
+    return compare(a, b) > 0;
+}
+
+inline bool operator<=(const biguint_t& a, const biguint_t& b) {
+    return compare(a, b) <= 0;
+}
+
+inline bool operator>=(const biguint_t& a, const biguint_t& b) {
+    return compare(a, b) >= 0;
+}
+
+inline biguint_t operator+(biguint_t a, const biguint_t& b) {
+    a += b;
+    return a;
+}
+
+inline biguint_t operator-(biguint_t a, const biguint_t& b) {
+    a -= b;
+    return a;
+}
+
+biguint_t operator*(const biguint_t& a, const biguint_t& b);
+
+inline biguint_t operator/(biguint_t a, const biguint_t& b) {
+    a /= b;
+    return a;
+}
+
+inline biguint_t operator%(biguint_t a, const biguint_t& b) {
+    a %= b;
+    return a;
+}
+
+inline biguint_t operator<<(biguint_t a, size_t shift) {
+    a <<= shift;
+    return a;
+}
+
+inline biguint_t operator>>(biguint_t a, size_t shift) {
+    a >>= shift;
+    return a;
+}
+
+std::ostream& operator<<(std::ostream& stream, const biguint_t& value);
+std::string to_hex(const biguint_t& value);
+
+// Число со знаком: модуль biguint_t и знак; ноль всегда неотрицателен.
+// Деление округляет к нулю, остаток берёт знак делимого — как у int.
+class bigint_t {
+public:
+    bigint_t() = default;
+    bigint_t(biguint_t magnitude, bool negative = false)
+        : magnitude_(std::move(magnitude)), negative_(negative && !magnitude_.is_zero()) {}
+
+    static bigint_t from_int(int64_t value);
+    // Десятичная строка, возможно с минусом
+    static bigint_t from_string(const char* buff);
+
+    const biguint_t& magnitude() const {
+        return magnitude_;
+    }
+
+    bool negative() const {
+        return negative_;
+    }
+
+    bigint_t operator-() const {
+        return bigint_t(magnitude_, !negative_);
+    }
+
+    bigint_t& operator+=(const bigint_t& other);
+    bigint_t& operator-=(const bigint_t& other);
+    bigint_t& operator*=(const bigint_t& other);
+    bigint_t& operator/=(const bigint_t& other);
+    bigint_t& operator%=(const bigint_t& other);
+
+private:
+    // this += other со знаком other, обращённым при negate
+    void add(const bigint_t& other, bool negate);
+
+    biguint_t magnitude_;
+    bool negative_ = false;
+};
+
+inline int compare(const bigint_t& a, const bigint_t& b) {
+    if (a.negative() != b.negative()) return a.negative() ? -1 : 1;
+    int c = compare(a.magnitude(), b.magnitude());
+    return a.negative() ? -c : c;
+}
+
+inline bool operator==(const bigint_t& a, const bigint_t& b) {
+    return compare(a, b) == 0;
+}
+
+inline bool operator!=(const bigint_t& a, const bigint_t& b) {
+    return compare(a, b) != 0;
+}
+
+inline bool operator<(const bigint_t& a, const bigint_t& b) {
+    return compare(a, b) < 0;
+}
+
+inline bool operator>(const bigint_t& a, const bigint_t& b) {
+    return compare(a, b) > 0;
+}
+
+inline bool operator<=(const bigint_t& a, const bigint_t& b) {
+    return compare(a, b) <= 0;
+}
+
+inline bool operator>=(const bigint_t& a, const bigint_t& b) {
+    return compare(a, b) >= 0;
+}
+
+inline bigint_t operator+(bigint_t a, const bigint_t& b) {
+    a += b;
+    return a;
+}
+
+inline bigint_t operator-(bigint_t a, const bigint_t& b) {
+    a -= b;
+    return a;
+}
+
+inline bigint_t operator*(const bigint_t& a, const bigint_t& b) {
+    return bigint_t(a.magnitude() * b.magnitude(), a.negative() != b.negative());
+}
 
-uint2022_t operator+(const uint2022_t& lhs, const uint2022_t& rhs);
-uint2022_t operator-(const uint2022_t& lhs, const uint2022_t& rhs);
-uint2022_t operator*(const uint2022_t& lhs, const uint2022_t& rhs);
-uint2022_t operator/(const uint2022_t& lhs, const uint2022_t& rhs);
+inline bigint_t operator/(bigint_t a, const bigint_t& b) {
+    a /= b;
+    return a;
+}
 
-bool operator==(const uint2022_t& lhs, const uint2022_t& rhs);
-bool operator!=(const uint2022_t& lhs, const uint2022_t& rhs);
-bool operator<(const uint2022_t& lhs, const uint2022_t& rhs);
+inline bigint_t operator%(bigint_t a, const bigint_t& b) {
+    a %= b;
+    return a;
+}
 
-std::ostream& operator<<(std::ostream& stream, const uint2022_t& value);
+std::ostream& operator<<(std::ostream& stream, const bigint_t& value);
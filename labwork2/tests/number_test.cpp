@@ -1,5 +1,6 @@
 #include <lib/number.h>
 #include <gtest/gtest.h>
+#include <sstream>
 #include <tuple>
 
 class ConvertingTestsSuite : public testing::TestWithParam<std::tuple<uint32_t, const char*, bool>> {
@@ -109,4 +110,711 @@ INSTANTIATE_TEST_SUITE_P(
             "1469832487054184013178321496623041557517329857560238757278117847507488415462666081345922349701550571520"
         )
     )
-);
\ No newline at end of file
+);
+
+class DivisionTestsSuite
+    : public testing::TestWithParam<
+        std::tuple<
+            const char*, // lhs
+            const char*, // rhs
+            const char*, // /
+            const char*  // %
+        >
+    > {
+};
+
+TEST_P(DivisionTestsSuite, DivTest) {
+    uint2022_t a = from_string(std::get<0>(GetParam()));
+    uint2022_t b = from_string(std::get<1>(GetParam()));
+
+    ASSERT_EQ(a / b, from_string(std::get<2>(GetParam())));
+}
+
+TEST_P(DivisionTestsSuite, ModTest) {
+    uint2022_t a = from_string(std::get<0>(GetParam()));
+    uint2022_t b = from_string(std::get<1>(GetParam()));
+
+    ASSERT_EQ(a % b, from_string(std::get<3>(GetParam())));
+}
+
+TEST_P(DivisionTestsSuite, DivModTest) {
+    uint2022_t a = from_string(std::get<0>(GetParam()));
+    uint2022_t b = from_string(std::get<1>(GetParam()));
+
+    uint2022_divmod_t result = divmod(a, b);
+
+    ASSERT_EQ(result.quotient, from_string(std::get<2>(GetParam())));
+    ASSERT_EQ(result.remainder, from_string(std::get<3>(GetParam())));
+    ASSERT_EQ(result.quotient * b + result.remainder, a);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Group,
+    DivisionTestsSuite,
+    testing::Values(
+        std::make_tuple("1",
+                        "1",
+                        "1",
+                        "0"),
+        std::make_tuple("1024",
+                        "7",
+                        "146",
+                        "2"),
+        std::make_tuple("405272312330606683982498447530407677486444946329741974138101544027695953739965",
+                        "3626777458843887524118528",
+                        "111744466521471062588629470729710044638866394325887658",
+                        "2417851639229258349412541"),
+        std::make_tuple("4149515568880992958512407863691161151012446232242436899995657329690652811412908146399707048947103794288197886611300789182395151075411775307886874834113963687061181803401509523685375",
+                        "2037035976334486086268445688409378161051468393665936250636140449354381299763336706183397377",
+                        "2037035976334486086268445688409378161051468393665936250636140449354381299763336706183397375",
+                        "0"),
+        std::make_tuple("36360291795869936842385267079543319118023385026001623040346035832580600191583895484198508262979388783308179702534403855752855931517013066142992430916562025780021771247847643450125342836565813209972590371590152578728008385990139795377610001",
+                        "190683748116796615589766511371277507701260426349148337437043654910886245033973163156381027646240890976422037778530726266",
+                        "190683748116796615589766511371277507701260426349148337437043654910886245033973163156381027646240890976422037778530726232",
+                        "289"),
+        std::make_tuple("114813069527425452423283320117768198402231770208869520047764273682576626139237031385665948631650626991844596463898746277344711896086305533142593135616665318539129989145312280000688779148240044871428926990063486244781615463646388363947317026040466353970904996558162398808944629605623311649536164221970332681344168908984458505602379484807914058900934776500429002716706625830522008132236281291761267883317206598995396418127021779858404042159853183251540889433902091920554957783589672039160081957216630582755380425583726015528348786419432054508915275783882625175435528800822842770817965466107863752383597266",
+                        "10715086071862673209484250490600018105614048117055336074437503883703510511249361224931983788156958581275946729175531468251871452856923140435984577574695301413326671632954217795724247005910154499831911117363563183615485807470994093004282273853751158757420309793558982096651212575106738993783877140480001",
+                        "10715086071862673209484250490600018105614048117055336074437503883703510511249361224931983788156958581275946729175531468251871452856923140435984577574701848194542463916694244175117902204214587783923997246942529766351678075063803442114048814038402967071722083161814102238669647088198509779890534195658751",
+                        "10715086071862673209484250490600018105614048117055336074437503883703510511249361224931983788156958581275946729175531468251871452856923140435984577574692028022718775491084204606027419406757937857785868052574079892247389673674589418449399003761425254600269423109431422025641995318560865946409449847458515"),
+        std::make_tuple("5",
+                        "10000000000000000000000000000000000000000",
+                        "0",
+                        "5"),
+        std::make_tuple("269653970229347386159395778618353710042696546841345985910145121736599013708251444699062715983611304031680170819807090036488184653221624933739271145959211186566651840137298227914453329401869141179179624428127508653257226023513694322210869665811240855745025766026879447359920868907719574457253034494436336205831",
+                        "4294967291",
+                        "62783707525410206007409563440690172660664517931795813042932233528993134701907895088336009398403426404971932723342150834668180632070295534583448623045453406356721853818955714118022448381404714446096494015913917388028188832955117916452339675294454030743170510917606763995241999831965559538705468221559",
+                        "490179162")
+    )
+);
+
+TEST(DivisionTest, ByZero) {
+    uint2022_t a = from_string("405272312330606683982498447530407677486444946329741970511324085183808429621437");
+
+    ASSERT_EQ(a / from_uint(0), from_uint(0));
+    ASSERT_EQ(a % from_uint(0), from_uint(0));
+}
+
+TEST(UsedLengthTest, TracksSignificantWords) {
+    ASSERT_EQ(from_uint(0).used, 0);
+    ASSERT_EQ(from_uint(7).used, 1);
+    ASSERT_EQ(from_string("18446744073709551616").used, 2);
+    ASSERT_EQ((from_string("18446744073709551616") - from_uint(1)).used, 1);
+    ASSERT_EQ((from_uint(5) - from_uint(5)).used, 0);
+    ASSERT_EQ((from_string("18446744073709551616") * from_string("18446744073709551616")).used, 3);
+}
+
+TEST(UsedLengthTest, NormalizeAfterDirectWrite) {
+    uint2022_t a;
+    a.data[3] = 1;
+    a.normalize();
+
+    ASSERT_EQ(a.used, 4);
+    ASSERT_EQ(a, from_string("6277101735386680763835789423207666416102355444464034512896"));
+}
+
+TEST(WidthTest, Uint256Wraps) {
+    uint_t<256> max_value;
+    for (int i = 0; i < uint_t<256>::SIZE; ++i)
+        max_value.data[i] = ~uint64_t(0);
+    max_value.normalize();
+
+    ASSERT_EQ(max_value + uint_t<256>::from_uint(1), uint_t<256>::from_uint(0));
+    ASSERT_EQ(uint_t<256>::from_uint(0) - uint_t<256>::from_uint(1), max_value);
+}
+
+TEST(WidthTest, Uint512Division) {
+    using uint512_t = uint_t<512>;
+    uint512_t a = uint512_t::from_string("3273390607896141870013189696827599152216642046043064789483291368096133796404674554883270092325904157150886684127560071009217256545885393053328527601721");
+    uint512_t b = uint512_t::from_string("1606938044258990275541962092341162602522202993782792835301379");
+
+    divmod_t<512> result = divmod(a, b);
+
+    ASSERT_EQ(result.quotient, uint512_t::from_string("2037035976334486086268445688409378161051468393665936250636136646402580615075132216073781248"));
+    ASSERT_EQ(result.remainder, uint512_t::from_string("11408855402054064613470328860729"));
+}
+
+TEST(WidthTest, Uint4096Multiplication) {
+    using uint4096_t = uint_t<4096>;
+    uint4096_t a = uint4096_t::from_string("136891479058588375991326027382088315966463695625337436471480190078368997177499076593800206155688941388250484440597994042813512732765695774566001");
+    uint4096_t b = uint4096_t::from_string("18815250448759004797747440398770460753278965824274520564699796772813240860593715176907610212053994345747048043436940455072863886866361465162101062196720299016151483118251038883996011300645825474625761742043131249");
+
+    std::stringstream stream;
+    stream << a * b;
+
+    ASSERT_EQ(stream.str(), "2575647462788388848994601323936583012479612131815852016028590143936575459974579700457388800737398705793364615518027208298322961022862497476656268886087324524147504059919402339695136306828280285713051255139940943410524689044692313557051460362708835252268797002755469329301355966246292686529222810219117490369246691604977495115933284085521762844796056065249");
+}
+
+TEST(PowTest, SmallBase) {
+    ASSERT_EQ(pow(from_uint(3), 1000), from_string("1322070819480806636890455259752144365965422032752148167664920368226828597346704899540778313850608061963909777696872582355950954582100618911865342725257953674027620225198320803878014774228964841274390400117588618041128947815623094438061566173054086674490506178125480344405547054397038895817465368254916136220830268563778582290228416398307887896918556404084898937609373242171846359938695516765018940588109060426089671438864102814350385648747165832010614366132173102768902855220001"));
+    ASSERT_EQ(pow(from_uint(2), 64), from_string("18446744073709551616"));
+    ASSERT_EQ(pow(from_uint(12345), 0), from_uint(1));
+    ASSERT_EQ(pow(from_uint(0), 5), from_uint(0));
+}
+
+TEST(SquareTest, MatchesMultiplication) {
+    uint2022_t a = from_string("405272312330606683982498447530407677486444946329741974138101544027695953739965");
+    uint2022_t b = a;
+
+    ASSERT_EQ(square(a), a * b);
+    ASSERT_EQ(square(pow(from_uint(3), 600)), pow(from_uint(3), 1200));
+
+    uint_t<256> c = uint_t<256>::from_string("115792089237316195423570985008687907853269984665640564039457584007913129639935");
+    uint_t<256> d = c;
+    ASSERT_EQ(square(c), c * d);
+    ASSERT_EQ(square(c), uint_t<256>::from_uint(1));
+}
+
+// Множители по 60+ слов: произведение идёт через Карацубу
+TEST(KaratsubaTest, LargeOperands) {
+    using uint8192_t = uint_t<8192>;
+    uint8192_t a = pow(uint8192_t::from_uint(7), 1400);
+    uint8192_t b = pow(uint8192_t::from_uint(11), 1150);
+    uint8192_t product = a * b;
+
+    ASSERT_EQ(product / b, a);
+    ASSERT_EQ(product % a, uint8192_t::from_uint(0));
+    ASSERT_EQ(product % uint8192_t::from_uint(1000000007),
+              (a % uint8192_t::from_uint(1000000007)) * (b % uint8192_t::from_uint(1000000007)) % uint8192_t::from_uint(1000000007));
+
+    uint8192_t c = a;
+    ASSERT_EQ(square(a), a * c);
+}
+
+class DecimalTestsSuite : public testing::TestWithParam<const char*> {
+};
+
+TEST_P(DecimalTestsSuite, RoundTripTest) {
+    std::stringstream stream;
+    stream << from_string(GetParam());
+
+    ASSERT_EQ(stream.str(), GetParam());
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Group,
+    DecimalTestsSuite,
+    testing::Values(
+        "0",
+        "9",
+        "999999999999999999",
+        "9999999999999999999",
+        "10000000000000000000",
+        "10000000000000000001",
+        "18446744073709551615",
+        "100000000000000000000000000000000000000",
+        "100000000000000000000000000000000000001",
+        "405272312330606683982498447530407677486444946329741977764879002871583477858493"
+    )
+);
+
+// Больше 30000 цифр: разбор и печать идут делением пополам
+TEST(DecimalTest, LongRoundTrip) {
+    using uint131072_t = uint_t<131072>;
+    uint131072_t a = pow(uint131072_t::from_uint(3), 80000);
+
+    std::stringstream stream;
+    stream << a;
+    std::string s = stream.str();
+
+    ASSERT_EQ(s.size(), 38170);
+    ASSERT_EQ(s.substr(0, 20), "50162315224093335526");
+    ASSERT_EQ(uint131072_t::from_string(s.c_str()), a);
+
+    std::stringstream tail;
+    tail << a % uint131072_t::from_string("10000000000000000000");
+    ASSERT_EQ(uint131072_t::from_string(s.substr(s.size() - 19).c_str()), uint131072_t::from_string(tail.str().c_str()));
+}
+
+// Константы и арифметика при компиляции
+constexpr uint2022_t kP256 = 115792089210356248762697446949407573530086143415290314195533631308867097853951_u2022;
+
+static_assert(kP256 == pow(from_uint(2), 256) - pow(from_uint(2), 224) + pow(from_uint(2), 192) + pow(from_uint(2), 96) - from_uint(1));
+static_assert(kP256 % from_uint(1000000007) == from_uint(686394959));
+static_assert(divmod(kP256, pow(from_uint(2), 128)).quotient == 340282366841710300967557013911933812736_u2022);
+static_assert(divmod(kP256, pow(from_uint(2), 128)).remainder == 79228162514264337593543950335_u2022);
+static_assert(square(kP256) == kP256 * from_string("115792089210356248762697446949407573530086143415290314195533631308867097853951"));
+static_assert(from_uint(7) < from_uint(8) && from_uint(8) != from_uint(7));
+static_assert(0_u2022 == uint2022_t());
+
+constexpr uint_t<4096> kWide = pow(uint_t<4096>::from_uint(3), 1500);
+static_assert((kWide * pow(uint_t<4096>::from_uint(5), 500)) / pow(uint_t<4096>::from_uint(5), 500) == kWide);
+
+TEST(ConstexprTest, MatchesRuntime) {
+    constexpr uint2022_t table[] = {1_u2022, 18446744073709551616_u2022, kP256 * kP256};
+
+    ASSERT_EQ(table[0], from_uint(1));
+    ASSERT_EQ(table[1], from_string("18446744073709551616"));
+    ASSERT_EQ(table[2], square(from_string("115792089210356248762697446949407573530086143415290314195533631308867097853951")));
+    ASSERT_EQ(kWide, pow(uint_t<4096>::from_uint(3), 1500));
+}
+
+// Модуль на все 32 слова, как у RSA-2048
+const char* kModulus2048 = "20382932532153611781845362730196773052775716003891824181841724509012861339295781313483658555682000817617831219503872434562975869282319436125727614873220407601319789970136569490998009604777055395209615901078705487649029571618372630126457989344553561317599557661647188324331923921820012363768915653225553275771789591960006097450061847092265391928476585406526635263305762669773124489476218766036831854244524508591241461748944367578410429200482788437106888011699402163619253044849279157047345317449412402306833403386046693717190603640347217404702145804039184739804818146563853298189282044981562353813894767321245149601803";
+const char* kBase2048 = "50543175048198328236970249209766766118349897233381041304546382786331301887958532712594479913368336393653665232110071415090054418466113499615424739619617076243647077656757424053259490331496805170405858785201416813232930218033434494481981974268815618582336952644140769507544792112042048554622990546215436549534675793844051448179772882042162373296615413356711180657745512119372792324002232209627482100150198184993227850090400704983855598446400233562266784949550633868315529304050255872830311251172000222194719449337643716940820919119824041319255646160885632441630661629478652971451027323268788054570056781005802269290";
+const char* kExponent2048 = "17250375800343824446584342487162279275544752609692201581770196619865456416126964774108058910899159066245502480188905567613515491913330734004957322536713073446250860098166541237061692143741618467358802083316511342769992618909719288881234148962361517863482191189363359619707461107290309346977425577805692934779843533858541410604028349562019954388072705661399451133322714241835613788311423175967865801729915649708905543114335770138820934976577195524846530557198032518786659996676186680928504397619172172837687725593956075494110256637310550341042793531322148877527378760136964481957143836877832925523278962644198544051466";
+
+TEST(MontgomeryTest, MulMod) {
+    uint2022_montgomery_t ctx(from_string(kModulus2048));
+    uint2022_t a = from_string(kBase2048);
+    uint2022_t b = from_string("4704775943512541782926131490793565427963351819504802870257494985868632105644580429375754374509981258678487529799055707692769384153207360658405301624365214098983743171797964139741662928343265275386020127072840431291664505736322592512188385593505824848870991581047542625372772505482195171044936097905454267189625630635292863664466336226471048632375610800572290633883060220138431313528214682715395998538617498039138429419618053062772592024826213802173771592198809273022145204279219577616411359333831113282282222593237394372757349245462462345631644200887408698550071031667714200371153223187998973564667559013943962200891");
+
+    uint2022_t am = ctx.to_montgomery(a);
+    ASSERT_EQ(ctx.from_montgomery(am), a % ctx.modulus());
+    ASSERT_EQ(ctx.from_montgomery(ctx.mulmod(am, ctx.to_montgomery(b))),
+              from_string("8905021464153384698483593515492297207631558769084872241245236486621803393201858643486252950020614596073532663681281633459139222685060887342346529904008095326560266438019365197983581125568420552586834549019680956078934862357623396161561081968803717491718493071178084205509277807942573428220395789088331692748257796088776843771515920120326117174120746665824251131561541289065618942089329174584941741248453329844775596220171821903599590646614704035835719522188967708997185772236037344912340804728348098371154212834490078295261918297646382694968263131436194938137647299619743974198015952697508083398326049576644318770260"));
+    ASSERT_EQ(ctx.sqrmod(am), ctx.mulmod(am, am));
+}
+
+TEST(MontgomeryTest, PowMod) {
+    uint2022_montgomery_t ctx(from_string(kModulus2048));
+    uint2022_t expected = from_string("6273884176114710277318144274691511173049813713596155924948992179662047521813329694971443041417310770569515324826128836303563227854504304613258301230071363384702331572949500358258808841305416346996672815793191469926324398298272118715252407288148089369930129765204289909532134747238814526325983106846602956955984513637813466447338911408812949573733194866032655506466108521855587630170139051360355807446512545698979978520367550930505586934935040484469599199696478725990371230895193186557829074596763146210194154198728072077799238807926557027232974797032858254467369610385827353039146377143563195034911862685550851585273");
+
+    ASSERT_EQ(ctx.powmod(from_string(kBase2048), from_string(kExponent2048)), expected);
+    ASSERT_EQ(powmod(from_string(kBase2048), from_string(kExponent2048), from_string(kModulus2048)), expected);
+    ASSERT_EQ(ctx.powmod(from_uint(12345), from_uint(0)), from_uint(1));
+    ASSERT_EQ(ctx.powmod(from_uint(12345), from_uint(1)), from_uint(12345));
+}
+
+// 2^1279 - 1 простое: малая теорема Ферма на модуле в 20 слов
+TEST(MontgomeryTest, FermatMersenne) {
+    uint2022_t p = pow(from_uint(2), 1279) - from_uint(1);
+    uint2022_montgomery_t ctx(p);
+
+    for (uint32_t a : {2u, 3u, 65537u, 4294967295u}) {
+        ASSERT_EQ(ctx.powmod(from_uint(a), p - from_uint(1)), from_uint(1));
+        ASSERT_EQ(ctx.powmod(from_uint(a), p), from_uint(a));
+    }
+}
+
+TEST(MontgomeryTest, SmallAndEvenModulus) {
+    ASSERT_EQ(powmod(from_uint(4), from_uint(13), from_uint(497)), from_uint(445));
+    ASSERT_EQ(powmod(from_uint(7), from_uint(100), from_uint(1)), from_uint(0));
+    ASSERT_EQ(powmod(from_uint(3), from_uint(200), from_uint(1000)), from_uint(1));
+    ASSERT_EQ(powmod(from_string(kBase2048), from_string(kExponent2048), from_string("32382023967553772934581591574896720044227905630593012654681082065252309792704245303972646000492364847481127750580484898414814304223670166775762578111090469745263824265679024336451556211368033901043477049154486291569936352902914550276416535882011320826133987712403109402023785811222691263903962040484456")),
+              from_string("6590665989426714606955834423938631669745745836827082437613048460400039973381145520946450067459487858226762056693274713603771649643767693530045921719824760287127584380790740555532714166616431985219038933487356810935184121310761679954076508006314626105650049068240727635913832629863565584697741259138728"));
+    ASSERT_EQ(powmod(from_uint(3), from_uint(5), from_uint(0)), from_uint(0));
+}
+
+TEST(CompoundTest, MatchesBinaryOperators) {
+    uint2022_t a = from_string("405272312330606683982498447530407677486444946329741974138101544027695953739965");
+    uint2022_t b = from_string("3626777458843887524118528");
+    uint2022_t c = a;
+
+    c += b;
+    ASSERT_EQ(c, a + b);
+    c -= b;
+    ASSERT_EQ(c, a);
+    c *= b;
+    ASSERT_EQ(c, a * b);
+    c /= b;
+    ASSERT_EQ(c, a);
+    c %= b;
+    ASSERT_EQ(c, a % b);
+
+    c = a;
+    c *= c;
+    ASSERT_EQ(c, square(a));
+    c %= from_uint(1000000007);
+    ASSERT_EQ(c, square(a) % from_uint(1000000007));
+    c /= from_uint(0);
+    ASSERT_EQ(c, from_uint(0));
+}
+
+TEST(CompoundTest, UnderflowWraps) {
+    uint2022_t a = from_uint(1);
+    a -= from_uint(2);
+    a += from_uint(1);
+
+    ASSERT_EQ(a, from_uint(0));
+    ASSERT_EQ(a.used, 0);
+}
+
+TEST(CompoundTest, Accumulate) {
+    uint2022_t sum;
+    uint2022_t term = from_uint(1);
+    for (int i = 0; i < 1000; ++i) {
+        sum += term;
+        term *= from_uint(3);
+    }
+
+    // 1 + 3 + ... + 3^999 = (3^1000 - 1) / 2
+    ASSERT_EQ(sum, (pow(from_uint(3), 1000) - from_uint(1)) / from_uint(2));
+}
+
+TEST(ShiftTest, WordAndBitShifts) {
+    uint2022_t a = from_string("405272312330606683982498447530407677486444946329741974138101544027695953739965");
+
+    ASSERT_EQ(a << 1900, from_string("17118021430176875806459240187189349487534405660586821617497807260971638134179640200037950344250382278496444065423324776633285416381438348715605663559992555031347876004422841434581354384685073623826884426038706175625457888170643386230496524370033784077445256477700515588456193329359062209183251651501578720654471305857833782729846326008520218492041545835598742925522144465533194205189898786444815333200089632075357182660789943152461942784535989239840724225527807715569694985992102979519690074456586126643559911033746970556353678781579018277314294375764541351591365217368408064"));
+    ASSERT_EQ(a >> 100, from_string("319703483166135013357056057156686910549735243776"));
+    ASSERT_EQ((a << 128) >> 128, a);
+    ASSERT_EQ(a << 2048, from_uint(0));
+    ASSERT_EQ(a >> 300, from_uint(0));
+    ASSERT_EQ(from_uint(1) << 64, from_string("18446744073709551616"));
+
+    uint2022_t b = a;
+    b <<= 7;
+    ASSERT_EQ(b, a * from_uint(128));
+    b >>= 7;
+    ASSERT_EQ(b, a);
+}
+
+TEST(BitwiseTest, AndOrXor) {
+    uint2022_t a = from_string("405272312330606683982498447530407677486444946329741974138101544027695953739965");
+    uint2022_t b = from_string("115792089210356248762697446949407573530086143415290314195533631308867097853951");
+
+    ASSERT_EQ(a & b, from_string("57896044618658097711785492504343953926634992332820282019728792003956564820157"));
+    ASSERT_EQ(a | b, from_string("463168356922304835033410401975471297089896097412212006313906383332606486773759"));
+    ASSERT_EQ(a ^ b, from_string("405272312303646737321624909471127343163261105079391724294177591328649921953602"));
+    ASSERT_EQ((a ^ a).used, 0);
+    ASSERT_EQ((a & from_uint(0)).used, 0);
+}
+
+static_assert((from_uint(1) << 200) >> 199 == from_uint(2));
+static_assert((kP256 | from_uint(1)) == kP256 && (kP256 & from_uint(2)) == from_uint(2));
+static_assert([] {
+    uint2022_t a = kP256;
+    a *= a;
+    a /= kP256;
+    a %= pow(from_uint(2), 128);
+    return a == 79228162514264337593543950335_u2022;
+}());
+
+// 6 чисел: четыре идут через AVX2 (если он есть), два — скалярным путём
+TEST(BatchTest, MatchesScalar) {
+    uint2022_t max_value;
+    for (int i = 0; i < uint2022_t::SIZE; ++i)
+        max_value.data[i] = ~uint64_t(0);
+    max_value.normalize();
+
+    uint2022_t x[6] = {
+        max_value,
+        from_uint(0),
+        pow(from_uint(3), 1200),
+        from_string("18446744073709551615"),
+        pow(from_uint(2), 1500),
+        from_string("405272312330606683982498447530407677486444946329741974138101544027695953739965"),
+    };
+    uint2022_t y[6] = {
+        from_uint(1),
+        from_uint(1),
+        pow(from_uint(3), 1199),
+        from_uint(1),
+        pow(from_uint(2), 1500),
+        max_value,
+    };
+
+    uint2022_batch<6> a = uint2022_batch<6>::load(x);
+    uint2022_batch<6> b;
+    for (int lane = 0; lane < 6; ++lane)
+        b.set(lane, y[lane]);
+
+    uint2022_batch<6> sum = a + b;
+    uint2022_batch<6> diff = a - b;
+    uint2022_batch<6> product = a * 4294967295u;
+    std::array<signed char, 6> order = compare(a, b);
+
+    uint2022_t out[6];
+    diff.store(out);
+    for (int lane = 0; lane < 6; ++lane) {
+        ASSERT_EQ(sum.get(lane), x[lane] + y[lane]) << lane;
+        ASSERT_EQ(out[lane], x[lane] - y[lane]) << lane;
+        ASSERT_EQ(product.get(lane), x[lane] * from_uint(4294967295u)) << lane;
+        ASSERT_EQ(order[lane], x[lane] == y[lane] ? 0 : x[lane] < y[lane] ? -1 : 1) << lane;
+    }
+}
+
+TEST(HexTest, RoundTrip) {
+    uint2022_t a = from_string("405272312330606683982498447530407677486444946329741974138101544027695953739965");
+
+    ASSERT_EQ(to_hex(a), "380000000000000000000000000000000000000000000000000000000000000bd");
+    ASSERT_EQ(from_hex("0x380000000000000000000000000000000000000000000000000000000000000BD"), a);
+    ASSERT_EQ(from_hex(to_hex(pow(from_uint(3), 1200)).c_str()), pow(from_uint(3), 1200));
+    ASSERT_EQ(to_hex(from_uint(0)), "0");
+    ASSERT_EQ(to_hex(from_uint(255)), "ff");
+    ASSERT_EQ(from_hex("0"), from_uint(0));
+    ASSERT_EQ(to_hex(pow(from_uint(3), 1200)).size(), 476);
+}
+
+static_assert(0x380000000000000000000000000000000000000000000000000000000000000bd_u2022 == 405272312330606683982498447530407677486444946329741974138101544027695953739965_u2022);
+static_assert(from_hex("ffffffffffffffff") + from_uint(1) == 18446744073709551616_u2022);
+
+TEST(BytesTest, SingleValue) {
+    uint2022_t a = pow(from_uint(3), 1200);
+    std::vector<uint8_t> bytes(uint2022_t::BYTES);
+
+    a.write_bytes(bytes);
+    ASSERT_EQ(bytes[0], uint8_t(a.data[0]));
+    ASSERT_EQ(uint2022_t::read_bytes(bytes), a);
+
+    // 3 байта: младшие 24 бита
+    uint8_t small[3];
+    from_uint(0x123456).write_bytes(small);
+    ASSERT_EQ(small[0], 0x56);
+    ASSERT_EQ(small[2], 0x12);
+    ASSERT_EQ(uint2022_t::read_bytes(small), from_uint(0x123456));
+}
+
+TEST(BytesTest, BulkSpanAndStream) {
+    std::vector<uint2022_t> values;
+    for (uint32_t i = 0; i < 5000; ++i)
+        values.push_back(pow(from_uint(i + 2), i % 300));
+
+    std::vector<uint8_t> region(values.size() * uint2022_t::BYTES);
+    ASSERT_EQ(uint2022_t::write_bytes(values, region), values.size());
+
+    std::vector<uint2022_t> back(values.size());
+    ASSERT_EQ(uint2022_t::read_bytes(region, back), values.size());
+    ASSERT_EQ(back, values);
+
+    std::stringstream stream;
+    ASSERT_TRUE(uint2022_t::write_bytes(stream, values));
+    ASSERT_EQ(stream.str().size(), region.size());
+
+    std::vector<uint2022_t> read(values.size() + 10);
+    ASSERT_EQ(uint2022_t::read_bytes(stream, read), values.size());
+    read.resize(values.size());
+    ASSERT_EQ(read, values);
+}
+
+TEST(ParallelTest, SumMatchesSerial) {
+    std::vector<uint2022_t> values;
+    uint2022_t serial;
+    uint2022_t term = from_uint(1);
+    for (int i = 0; i < 50000; ++i) {
+        values.push_back(term);
+        serial += term;
+        term *= from_uint(3);
+        term += from_uint(i);
+    }
+
+    ASSERT_EQ(parallel_sum(values), serial);
+    ASSERT_EQ(parallel_sum(values, 1), serial);
+    ASSERT_EQ(parallel_sum(values, 7), serial);
+    ASSERT_EQ(parallel_sum(std::span<const uint2022_t>()), from_uint(0));
+}
+
+TEST(ParallelTest, ProductMatchesSerial) {
+    using uint16384_t = uint_t<16384>;
+    std::vector<uint16384_t> values;
+    uint16384_t serial = uint16384_t::from_uint(1);
+    for (uint32_t i = 0; i < 600; ++i) {
+        values.push_back(uint16384_t::from_uint(4294967291u - i * 2));
+        serial *= values.back();
+    }
+
+    ASSERT_EQ(parallel_product<16384>(values), serial);
+    ASSERT_EQ(parallel_product<16384>(values, 1), serial);
+    ASSERT_EQ(parallel_product<16384>(values, 5), serial);
+    ASSERT_EQ(parallel_product(std::span<const uint2022_t>()), from_uint(1));
+}
+
+TEST(ParallelTest, Factorial) {
+    ASSERT_EQ(factorial(0), from_uint(1));
+    ASSERT_EQ(factorial(20), from_string("2432902008176640000"));
+    ASSERT_EQ(factorial(300), from_string("306057512216440636035370461297268629388588804173576999416776741259476533176716867465515291422477573349939147888701726368864263907759003154226842927906974559841225476930271954604008012215776252176854255965356903506788725264321896264299365204576448830388909753943489625436053225980776521270822437639449120128678675368305712293681943649956460498166450227716500185176546469340112226034729724066333258583506870150169794168850353752137554910289126407157154830282284937952636580145235233156936482233436799254594095276820608062232812387383880817049600000000000000000000000000000000000000000000000000000000000000000000000000"));
+
+    // 5000! — 54233 бита
+    using uint65536_t = uint_t<65536>;
+    uint65536_t f = factorial<65536>(5000);
+    uint65536_t serial = uint65536_t::from_uint(1);
+    for (uint32_t k = 2; k <= 5000; ++k)
+        serial *= uint65536_t::from_uint(k);
+
+    ASSERT_EQ(f, serial);
+    std::stringstream stream;
+    stream << f;
+    ASSERT_EQ(stream.str().size(), 16326);
+    ASSERT_EQ(stream.str().substr(0, 30), "422857792660554352220106420023");
+}
+
+TEST(BigUintTest, InlineAndHeap) {
+    biguint_t small = biguint_t::from_string("340282366920938463463374607431768211455");
+    ASSERT_TRUE(small.is_inline());
+    ASSERT_EQ(small.size(), 2);
+
+    biguint_t big = small * small * small;
+    ASSERT_FALSE(big.is_inline());
+    ASSERT_EQ(big.size(), 6);
+
+    big >>= 256;
+    ASSERT_FALSE(big.is_zero());
+    biguint_t copy = big;
+    ASSERT_EQ(copy, big);
+    biguint_t moved = std::move(big);
+    ASSERT_EQ(moved, copy);
+}
+
+TEST(BigUintTest, Arithmetic) {
+    biguint_t a = biguint_t::from_string("123456789012345678901234567890123456789012345678901234567890");
+    biguint_t b = biguint_t::from_string("987654321098765432109876543210");
+
+    std::stringstream stream;
+    stream << a + b << " " << a - b << " " << a * b << " " << a / b << " " << a % b;
+    ASSERT_EQ(stream.str(),
+              "123456789012345678901234567891111111110111111111011111111100 "
+              "123456789012345678901234567889135802467913580246791358024680 "
+              "121932631137021795226185032733744855963374485596337448559633622923332237463801111263526900 "
+              "124999998860937500014238281249 "
+              "935329860093532986009353298600");
+
+    ASSERT_EQ(b - a, biguint_t());
+    ASSERT_EQ(a / biguint_t(), biguint_t());
+    ASSERT_EQ((a << 1000) >> 1000, a);
+    ASSERT_EQ(biguint_t::from<2022>(from_string("18446744073709551616")), biguint_t::from_hex("10000000000000000"));
+    ASSERT_EQ(a.to<2022>(), from_string("123456789012345678901234567890123456789012345678901234567890"));
+    ASSERT_EQ(to_hex(biguint_t::from_uint(255)), "ff");
+}
+
+TEST(BigUintTest, LargeProductsMatchSplitProducts) {
+    // 2500 и 2000 слов — через NTT; половины b короче порога и
+    // перемножаются Карацубой
+    std::vector<uint64_t> words(2500);
+    uint64_t x = 88172645463325252ULL;
+    for (uint64_t& w : words) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        w = x;
+    }
+
+    biguint_t a = biguint_t::from_words(words.data(), 2500);
+    biguint_t b = biguint_t::from_words(words.data() + 300, 2000);
+    biguint_t b_low = biguint_t::from_words(words.data() + 300, 1000);
+    biguint_t b_high = biguint_t::from_words(words.data() + 1300, 1000);
+
+    ASSERT_EQ(a * b, a * b_low + ((a * b_high) << (64 * 1000)));
+    ASSERT_EQ(a * a, a * biguint_t(a));
+    ASSERT_EQ((a * b) / b, a);
+    ASSERT_EQ((a * b) % b, biguint_t());
+}
+
+TEST(BigUintTest, MillionBitDecimal) {
+    // (10^n - 1)^2 = 99..9800..01
+    const size_t n = 40000;
+    biguint_t nines = biguint_t::from_string(std::string(n, '9').c_str());
+    std::stringstream stream;
+    stream << nines * nines;
+    ASSERT_EQ(stream.str(), std::string(n - 1, '9') + "8" + std::string(n - 1, '0') + "1");
+}
+
+TEST(BigIntTest, SignedArithmetic) {
+    bigint_t a = bigint_t::from_string("-170141183460469231731687303715884105728");
+    bigint_t b = bigint_t::from_int(7);
+
+    std::stringstream stream;
+    stream << a + b << " " << a - b << " " << a * b << " " << a / b << " " << a % b << " " << -a;
+    ASSERT_EQ(stream.str(),
+              "-170141183460469231731687303715884105721 "
+              "-170141183460469231731687303715884105735 "
+              "-1190988284223284622121811126011188740096 "
+              "-24305883351495604533098186245126300818 "
+              "-2 "
+              "170141183460469231731687303715884105728");
+
+    ASSERT_EQ(bigint_t::from_int(-7) / bigint_t::from_int(2), bigint_t::from_int(-3));
+    ASSERT_EQ(bigint_t::from_int(7) % bigint_t::from_int(-2), bigint_t::from_int(1));
+    ASSERT_EQ(a + (-a), bigint_t());
+    ASSERT_FALSE((a + (-a)).negative());
+    ASSERT_TRUE(a < b);
+    ASSERT_TRUE(-b < bigint_t());
+}
+
+TEST(GcdTest, Basic) {
+    ASSERT_EQ(gcd(from_uint(12), from_uint(18)), from_uint(6));
+    ASSERT_EQ(gcd(from_uint(0), from_uint(18)), from_uint(18));
+    ASSERT_EQ(gcd(from_uint(18), from_uint(0)), from_uint(18));
+    ASSERT_EQ(gcd(from_uint(0), from_uint(0)), from_uint(0));
+
+    // общий множитель — простое Мерсенна 2^127 - 1
+    uint2022_t p = (from_uint(1) << 127) - from_uint(1);
+    uint2022_t a = p * from_string("340282366920938463463374607431768211507") * from_uint(6);
+    uint2022_t b = p * from_string("1000000000000000000000000000000000000000000000000000000000007") * from_uint(10);
+    ASSERT_EQ(gcd(a, b), p * from_uint(2));
+    ASSERT_EQ(gcd(b, a), p * from_uint(2));
+}
+
+TEST(GcdTest, ConsecutiveFibonacci) {
+    // худший случай для алгоритма Евклида: все частные — единицы
+    uint2022_t a = from_uint(1);
+    uint2022_t b = from_uint(1);
+    for (int i = 0; i < 2900; ++i) {
+        uint2022_t c = a + b;
+        a = b;
+        b = c;
+    }
+
+    ASSERT_EQ(gcd(b, a), from_uint(1));
+    ASSERT_EQ(gcd(b * from_uint(7), a * from_uint(7)), from_uint(7));
+}
+
+TEST(ModInvTest, Basic) {
+    ASSERT_EQ(modinv(from_uint(3), from_uint(7)), from_uint(5));
+    ASSERT_EQ(modinv(from_uint(10), from_uint(7)), from_uint(5));
+    ASSERT_EQ(modinv(from_uint(6), from_uint(9)), from_uint(0));
+    ASSERT_EQ(modinv(from_uint(0), from_uint(9)), from_uint(0));
+    ASSERT_EQ(modinv(from_uint(3), from_uint(0)), from_uint(0));
+    ASSERT_EQ(modinv(from_uint(1), from_uint(1)), from_uint(0));
+}
+
+TEST(ModInvTest, LargeModulus) {
+    uint2022_t m = (from_uint(1) << 1279) - from_uint(1);
+    uint2022_t even = from_uint(1) << 2000;
+    uint2022_t a = from_string("123456789012345678901234567890123456789012345678901234567890123456789");
+    a = a * a * a;
+
+    uint2022_t inverse = modinv(a, m);
+    ASSERT_TRUE(inverse < m);
+    ASSERT_EQ(a * inverse % m, from_uint(1));
+    ASSERT_EQ(inverse, powmod(a, m - from_uint(2), m));
+
+    ASSERT_EQ(a * modinv(a, even) % even, from_uint(1));
+    ASSERT_EQ(modinv(a + from_uint(1), even), from_uint(0));
+}
+
+TEST(PrimeTest, SmallNumbers) {
+    int count = 0;
+    for (uint32_t n = 0; n < 20000; ++n)
+        count += is_probable_prime(from_uint(n));
+    ASSERT_EQ(count, 2262);
+
+    // числа Кармайкла и сильные псевдопростые по основаниям 2..23 и 2..37
+    ASSERT_FALSE(is_probable_prime(from_uint(561)));
+    ASSERT_FALSE(is_probable_prime(from_uint(1105)));
+    ASSERT_FALSE(is_probable_prime(from_string("3825123056546413051")));
+    ASSERT_FALSE(is_probable_prime(from_string("318665857834031151167461")));
+    ASSERT_TRUE(is_probable_prime(from_string("18446744073709551557")));
+    ASSERT_FALSE(is_probable_prime(from_string("18446744073709551559")));
+}
+
+TEST(PrimeTest, LargeNumbers) {
+    uint2022_t m127 = (from_uint(1) << 127) - from_uint(1);
+    uint2022_t m521 = (from_uint(1) << 521) - from_uint(1);
+    uint2022_t m523 = (from_uint(1) << 523) - from_uint(1);
+
+    ASSERT_TRUE(is_probable_prime(m127));
+    ASSERT_TRUE(is_probable_prime(m521));
+    ASSERT_FALSE(is_probable_prime(m523));
+    ASSERT_FALSE(is_probable_prime(m127 * m127));
+    ASSERT_FALSE(is_probable_prime(m127 * ((from_uint(1) << 89) - from_uint(1))));
+    ASSERT_FALSE(is_probable_prime(m521 * from_uint(4099)));
+}
+
+TEST(PrimeTest, ParallelCandidates) {
+    // нечётные числа сразу за 2^512
+    std::vector<uint2022_t> candidates;
+    for (uint32_t k = 1; k < 200; k += 2)
+        candidates.push_back((from_uint(1) << 512) + from_uint(k));
+
+    bool serial[100] = {};
+    size_t expected = 0;
+    for (size_t i = 0; i < candidates.size(); ++i)
+        expected += serial[i] = is_probable_prime(candidates[i]);
+
+    for (unsigned threads : {1u, 3u, 0u}) {
+        bool result[100] = {};
+        ASSERT_EQ(is_probable_prime(candidates, std::span<bool>(result, candidates.size()), limb::kMillerRabinRounds, threads), expected);
+        ASSERT_TRUE(std::equal(result, result + candidates.size(), serial));
+    }
+    ASSERT_GT(expected, 0u);
+    ASSERT_TRUE(is_probable_prime((from_uint(1) << 512) + from_uint(75)));
+}